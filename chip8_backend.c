@@ -0,0 +1,390 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "chip8_cpu.h"
+#include "chip8_opcodes.h"
+#include "chip8_slab.h"
+#include "chip8_backend.h"
+
+typedef void (*opcode_fn)(void);
+
+// ---------------- 参考解释器 ----------------
+
+static void interp_run(int cycles)
+{
+    for (int i = 0; i < cycles; i++) {
+        cycle();
+    }
+}
+
+// ---------------- 快速路径 ----------------
+
+// 二级分发表（未列出的指令为NULL，按未知指令处理）
+static const opcode_fn table_0[256] = {
+    [0xE0] = oc_00e0, [0xEE] = oc_00ee
+};
+
+static const opcode_fn table_8[16] = {
+    [0x0] = oc_8xy0, [0x1] = oc_8xy1, [0x2] = oc_8xy2, [0x3] = oc_8xy3,
+    [0x4] = oc_8xy4, [0x5] = oc_8xy5, [0x6] = oc_8xy6, [0x7] = oc_8xy7,
+    [0xE] = oc_8xye
+};
+
+static const opcode_fn table_e[256] = {
+    [0x9E] = oc_ex9e, [0xA1] = oc_exa1
+};
+
+static const opcode_fn table_f[256] = {
+    [0x07] = oc_fx07, [0x0A] = oc_fx0a, [0x15] = oc_fx15, [0x18] = oc_fx18,
+    [0x1E] = oc_fx1e, [0x29] = oc_fx29, [0x33] = oc_fx33, [0x55] = oc_fx55,
+    [0x65] = oc_fx65
+};
+
+static void dispatch_0(void)
+{
+    opcode_fn fn = table_0[CHIP8_CPU->opcode & 0x00FF];
+    fn ? fn() : oc_null();
+}
+
+static void dispatch_8(void)
+{
+    opcode_fn fn = table_8[CHIP8_CPU->opcode & 0x000F];
+    fn ? fn() : oc_null();
+}
+
+static void dispatch_e(void)
+{
+    opcode_fn fn = table_e[CHIP8_CPU->opcode & 0x00FF];
+    fn ? fn() : oc_null();
+}
+
+static void dispatch_f(void)
+{
+    opcode_fn fn = table_f[CHIP8_CPU->opcode & 0x00FF];
+    fn ? fn() : oc_null();
+}
+
+// 一级分发表（按指令高4位）
+static const opcode_fn table_top[16] = {
+    dispatch_0, oc_1nnn, oc_2nnn, oc_3xnn, oc_4xnn, oc_5xy0, oc_6xnn, oc_7xnn,
+    dispatch_8, oc_9xy0, oc_annn, oc_bxnn, oc_cxnn, oc_dxyn, dispatch_e, dispatch_f
+};
+
+// 与cycle()语义完全一致：取指/步进PC/执行/定时器
+// 区别：定时器阈值（含浮点除法）每批只算一次（批内速度系数不变），实例指针保存在局部变量
+static void fast_run(int cycles)
+{
+    chip8_cpu_t* cpu = CHIP8_CPU;
+    const uint32_t threshold = timer_threshold();
+
+    for (int i = 0; i < cycles; i++) {
+        cpu->opcode = (cpu->memory[cpu->pc] << 8) | cpu->memory[cpu->pc + 1];
+        cpu->pc += 2;
+        table_top[cpu->opcode >> 12]();
+
+        if (++cpu->timer_ticks >= threshold) {
+            if (cpu->delayTimer > 0) cpu->delayTimer--;
+            if (cpu->soundTimer > 0) cpu->soundTimer--;
+            cpu->timer_ticks = 0;
+        }
+    }
+}
+
+// ---------------- 锁步校验 ----------------
+
+// 每个被校验实例一份影子状态：影子实例跨批持续运行，只在窗口结束时比对
+typedef struct {
+    const chip8_cpu_t* cpu;       // 被校验实例
+    chip8_cpu_t* start;           // 当前窗口起点快照（用于定位分歧）
+    chip8_cpu_t* shadow;          // 参考解释器的影子实例
+    uint32_t done;                // 当前窗口已执行的指令数
+    uint64_t executed;            // 该实例自建立影子状态（复位/加载/读档）起已执行的指令数
+} lockstep_slot_t;
+
+static const chip8_backend_t* ls_checked = &backend_fast;
+static uint32_t ls_interval = LOCKSTEP_DEFAULT_INTERVAL;
+static lockstep_slot_t* ls_slots = NULL;
+static int ls_slot_count = 0;
+static int ls_slot_capacity = 0;
+static int ls_cursor = 0;               // 下一次查找的起点（网格/基准按固定顺序轮流执行实例，通常一次命中）
+static uint64_t ls_executed = 0;        // 锁步模式下所有实例累计执行的指令数（仅用于统计）
+static uint32_t ls_windows = 0;
+static uint32_t ls_divergences = 0;
+
+// 在指定实例上执行后端（临时切换CHIP8_CPU）
+static void run_on(chip8_cpu_t* cpu, const chip8_backend_t* backend, int cycles)
+{
+    chip8_cpu_t* saved = CHIP8_CPU;
+    CHIP8_CPU = cpu;
+    backend->run(cycles);
+    CHIP8_CPU = saved;
+}
+
+// 复制一份实例（影子状态直接从分配器取得，不经cpu_create/cpu_free，避免触发lockstep_sync）
+static chip8_cpu_t* slot_copy(const chip8_cpu_t* cpu)
+{
+    chip8_cpu_t* copy = slab_alloc();
+    if (!copy) {
+        fprintf(stderr, "Failed to allocate lockstep shadow instance\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(copy, cpu, sizeof(chip8_cpu_t));
+    return copy;
+}
+
+// 查找实例的影子状态（create为1时不存在则以实例当前状态新建，否则返回NULL）
+static lockstep_slot_t* slot_find(chip8_cpu_t* cpu, int create)
+{
+    for (int n = 0; n < ls_slot_count; n++) {
+        int i = (ls_cursor + n) % ls_slot_count;
+        if (ls_slots[i].cpu == cpu) {
+            ls_cursor = (i + 1) % ls_slot_count;
+            return &ls_slots[i];
+        }
+    }
+    if (!create) return NULL;
+
+    if (ls_slot_count == ls_slot_capacity) {
+        ls_slot_capacity = ls_slot_capacity ? ls_slot_capacity * 2 : 16;
+        ls_slots = (lockstep_slot_t*)realloc(ls_slots, ls_slot_capacity * sizeof(lockstep_slot_t));
+        if (!ls_slots) {
+            fprintf(stderr, "Failed to allocate lockstep table\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    lockstep_slot_t* slot = &ls_slots[ls_slot_count++];
+    slot->cpu = cpu;
+    slot->start = slot_copy(cpu);
+    slot->shadow = slot_copy(cpu);
+    slot->done = 0;
+    slot->executed = 0;
+    return slot;
+}
+
+// 逐字段比较两份状态（a为被校验后端，b为参考解释器），print为1时打印不同的字段，返回不同字段数
+static int diff_state(const chip8_cpu_t* a, const chip8_cpu_t* b, int print)
+{
+    int fields = 0;
+
+#define DIFF_SCALAR(name, fmt) \
+    if (a->name != b->name) { \
+        fields++; \
+        if (print) printf("  %-12s " fmt " != " fmt "\n", #name, (unsigned)a->name, (unsigned)b->name); \
+    }
+
+    for (int i = 0; i < 16; i++) {
+        if (a->registers[i] != b->registers[i]) {
+            fields++;
+            if (print) printf("  V%-11X %02X != %02X\n", i, a->registers[i], b->registers[i]);
+        }
+    }
+    DIFF_SCALAR(index, "%03X");
+    DIFF_SCALAR(pc, "%03X");
+    DIFF_SCALAR(sp, "%X");
+    for (int i = 0; i < 16; i++) {
+        if (a->stack[i] != b->stack[i]) {
+            fields++;
+            if (print) printf("  stack[%X]     %03X != %03X\n", i, a->stack[i], b->stack[i]);
+        }
+    }
+    DIFF_SCALAR(delayTimer, "%02X");
+    DIFF_SCALAR(soundTimer, "%02X");
+    DIFF_SCALAR(opcode, "%04X");
+    DIFF_SCALAR(draw_flag, "%u");
+    DIFF_SCALAR(timer_ticks, "%u");
+    DIFF_SCALAR(quirks, "%02X");
+    DIFF_SCALAR(cycles_per_frame, "%u");
+    DIFF_SCALAR(rng_state, "%08X");
+#undef DIFF_SCALAR
+
+    if (memcmp(a->keymap, b->keymap, sizeof(a->keymap)) != 0) {
+        fields++;
+        if (print) printf("  keymap       %.16s != %.16s\n", a->keymap, b->keymap);
+    }
+
+    // 大块数组只报告差异数量与首个位置
+    int count = 0, first = -1;
+    for (int i = 0; i < (int)sizeof(a->keypad); i++) {
+        if (a->keypad[i] != b->keypad[i]) { if (first < 0) first = i; count++; }
+    }
+    if (count) {
+        fields++;
+        if (print) printf("  keypad       %d keys differ (first key %X)\n", count, first);
+    }
+
+    count = 0, first = -1;
+    for (int i = 0; i < (int)sizeof(a->memory); i++) {
+        if (a->memory[i] != b->memory[i]) { if (first < 0) first = i; count++; }
+    }
+    if (count) {
+        fields++;
+        if (print) printf("  memory       %d bytes differ (first at %03X: %02X != %02X)\n",
+            count, first, a->memory[first], b->memory[first]);
+    }
+
+    count = 0, first = -1;
+    for (int i = 0; i < (int)sizeof(a->video); i++) {
+        if (a->video[i] != b->video[i]) { if (first < 0) first = i; count++; }
+    }
+    if (count) {
+        fields++;
+        if (print) printf("  video        %d pixels differ (first at %d,%d)\n", count, first % 64, first / 64);
+    }
+    return fields;
+}
+
+// 从窗口起点单步重放，定位并报告首条产生分歧的指令
+// 返回后primary与影子实例均为参考解释器在窗口结束时的状态
+static void lockstep_locate(lockstep_slot_t* slot, chip8_cpu_t* primary)
+{
+    int steps = (int)slot->done;
+    uint64_t first = slot->executed - slot->done; // 窗口首条指令在该实例中的序号
+    memcpy(primary, slot->start, sizeof(chip8_cpu_t));
+    memcpy(slot->shadow, slot->start, sizeof(chip8_cpu_t));
+
+    int step = 0, found = 0;
+    while (step < steps && !found) {
+        uint16_t pc = slot->shadow->pc;
+        run_on(primary, ls_checked, 1);
+        run_on(slot->shadow, &backend_interp, 1);
+        if (diff_state(primary, slot->shadow, 0)) {
+            printf("[LOCKSTEP] %s diverged from interp at instruction %llu: PC=%03X opcode=%04X\n",
+                ls_checked->name, (unsigned long long)(first + step), pc, slot->shadow->opcode);
+            printf("  field        %s != interp\n", ls_checked->name);
+            diff_state(primary, slot->shadow, 1);
+            found = 1;
+        }
+        step++;
+    }
+    if (!found) {
+        printf("[LOCKSTEP] divergence in window at instruction %llu did not reproduce on replay\n",
+            (unsigned long long)first);
+    }
+
+    // 以参考状态继续执行窗口剩余部分
+    run_on(slot->shadow, &backend_interp, steps - step);
+    memcpy(primary, slot->shadow, sizeof(chip8_cpu_t));
+}
+
+// 结束当前窗口：比对完整状态（分歧时定位并以参考状态继续），然后以当前状态开始新窗口
+static void lockstep_check(lockstep_slot_t* slot, chip8_cpu_t* primary)
+{
+    if (slot->done == 0) return;
+
+    // memcmp为快速路径，结构体填充字节不同时再逐字段确认
+    if (memcmp(primary, slot->shadow, sizeof(chip8_cpu_t)) != 0 && diff_state(primary, slot->shadow, 0)) {
+        ls_divergences++;
+        lockstep_locate(slot, primary);
+    }
+    memcpy(slot->start, primary, sizeof(chip8_cpu_t));
+    slot->done = 0;
+    ls_windows++;
+}
+
+// 吸收批之间运行方对实例的修改：
+// draw_flag由运行方清零，直接同步到影子实例（每批结束时已确认两者一致）；
+// 按键变化时先以原按键结束当前窗口，保证窗口内按键不变、单步重放可复现
+static void lockstep_external(lockstep_slot_t* slot, chip8_cpu_t* primary)
+{
+    slot->shadow->draw_flag = primary->draw_flag;
+    if (memcmp(primary->keypad, slot->shadow->keypad, sizeof(primary->keypad)) == 0) return;
+
+    uint8_t keypad[sizeof(primary->keypad)];
+    memcpy(keypad, primary->keypad, sizeof(keypad));
+    memcpy(primary->keypad, slot->shadow->keypad, sizeof(keypad));
+    lockstep_check(slot, primary);
+    memcpy(primary->keypad, keypad, sizeof(keypad));
+    memcpy(slot->start->keypad, keypad, sizeof(keypad));
+    memcpy(slot->shadow->keypad, keypad, sizeof(keypad));
+}
+
+// 锁步运行：被校验后端在CHIP8_CPU上执行，参考解释器在该实例的影子实例上执行相同条数
+// 窗口跨批累计，每interval条指令比对一次完整状态（批很小时开销仍只取决于interval）
+static void lockstep_run(int cycles)
+{
+    chip8_cpu_t* primary = CHIP8_CPU;
+    lockstep_slot_t* slot = slot_find(primary, 1);
+    lockstep_external(slot, primary);
+
+    while (cycles > 0) {
+        uint32_t room = (slot->done < ls_interval) ? ls_interval - slot->done : 1;
+        int chunk = ((uint32_t)cycles < room) ? cycles : (int)room;
+        ls_checked->run(chunk);
+        run_on(slot->shadow, &backend_interp, chunk);
+
+        slot->done += chunk;
+        slot->executed += chunk;
+        ls_executed += chunk;
+        cycles -= chunk;
+        if (slot->done >= ls_interval) lockstep_check(slot, primary);
+    }
+
+    // 运行方会在批后清零draw_flag，清零前确认两者一致，否则立即结束窗口比对
+    if (primary->draw_flag != slot->shadow->draw_flag) lockstep_check(slot, primary);
+}
+
+// ---------------- 后端表 ----------------
+
+const chip8_backend_t backend_interp = { "interp", interp_run };
+const chip8_backend_t backend_fast = { "fast", fast_run };
+const chip8_backend_t backend_lockstep = { "lockstep", lockstep_run };
+
+// 按名称查找后端
+const chip8_backend_t* backend_find(const char* name)
+{
+    static const chip8_backend_t* const backends[] = { &backend_interp, &backend_fast, &backend_lockstep };
+    for (size_t i = 0; i < sizeof(backends) / sizeof(backends[0]); i++) {
+        if (strcmp(backends[i]->name, name) == 0) return backends[i];
+    }
+    return NULL;
+}
+
+// 设置锁步校验的被校验后端与比对间隔
+void lockstep_configure(const chip8_backend_t* checked, uint32_t interval)
+{
+    if (checked && checked != &backend_lockstep) ls_checked = checked;
+    ls_interval = interval ? interval : 1;
+}
+
+// 累计分歧次数
+uint32_t lockstep_divergences(void)
+{
+    return ls_divergences;
+}
+
+// 结束实例的当前窗口并释放其影子状态
+void lockstep_sync(const chip8_cpu_t* cpu)
+{
+    lockstep_slot_t* slot = slot_find((chip8_cpu_t*)cpu, 0);
+    if (!slot) return;
+
+    chip8_cpu_t* primary = (chip8_cpu_t*)cpu;
+    lockstep_external(slot, primary);
+    lockstep_check(slot, primary);
+    slab_free(slot->start);
+    slab_free(slot->shadow);
+    int i = (int)(slot - ls_slots);
+    ls_slots[i] = ls_slots[--ls_slot_count];
+    ls_cursor = (ls_slot_count > 0) ? i % ls_slot_count : 0;
+}
+
+// 打印统计并释放所有影子实例（未结束的窗口先比对）
+uint32_t lockstep_close(void)
+{
+    while (ls_slot_count > 0) {
+        lockstep_sync(ls_slots[0].cpu);
+    }
+    free(ls_slots);
+    ls_slots = NULL;
+    ls_slot_capacity = 0;
+    ls_cursor = 0;
+
+    if (ls_executed > 0) {
+        printf("Lockstep finished: %llu instructions in %u windows checked (%s vs interp), %u divergences\n",
+            (unsigned long long)ls_executed, ls_windows, ls_checked->name, ls_divergences);
+        ls_executed = 0;
+        ls_windows = 0;
+    }
+    return ls_divergences;
+}
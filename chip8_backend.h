@@ -0,0 +1,34 @@
+#ifndef CHIP8_BACKEND_H_
+#define CHIP8_BACKEND_H_
+
+#include <stdint.h>
+
+#include "chip8_cpu.h"
+
+// 执行后端参数
+#define LOCKSTEP_DEFAULT_INTERVAL 1000 // 默认每1000条指令比对一次完整状态
+
+// 执行后端：在CHIP8_CPU上执行cycles条指令（调用前由运行方切换CHIP8_CPU，可按实例选择后端）
+typedef struct {
+    const char* name;
+    void (*run)(int cycles);
+} chip8_backend_t;
+
+// 可选后端
+extern const chip8_backend_t backend_interp;    // 参考解释器（逐条调用cycle()）
+extern const chip8_backend_t backend_fast;      // 快速路径（批内只计算一次定时器阈值，按表分发指令）
+extern const chip8_backend_t backend_lockstep;  // 锁步校验：被校验后端（默认快速路径）与参考解释器并行执行并比对状态
+
+// 后端函数声明
+const chip8_backend_t* backend_find(const char* name); // 按名称查找后端（未知名称返回NULL）
+
+// 锁步校验：每个实例有一份跨批持续运行的影子实例，每interval条指令比对一次完整chip8_cpu_t状态
+// （批之间的按键变化也会结束当前窗口）；发现差异时从窗口起点单步重放，
+// 报告首个分歧的指令序号/PC/指令及不同的字段，然后以参考状态继续
+// checked为被校验后端（interp或fast，NULL保持不变）
+void lockstep_configure(const chip8_backend_t* checked, uint32_t interval);
+void lockstep_sync(const chip8_cpu_t* cpu);     // 实例将被外部修改或释放前调用（复位/加载ROM/读档/调试器接管）：结束并比对当前窗口，下一批从实例状态重新开始
+uint32_t lockstep_close(void);                  // 比对未结束的窗口，打印统计并释放影子实例（返回累计分歧次数）
+uint32_t lockstep_divergences(void);            // 累计分歧次数
+
+#endif
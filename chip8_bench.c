@@ -0,0 +1,167 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "chip8_cpu.h"
+#include "chip8_slab.h"
+#include "chip8_bench.h"
+
+// 硬件计数器
+typedef enum {
+    COUNTER_CACHE_MISSES = 0,     // 末级缓存未命中
+    COUNTER_L1D_MISSES,           // L1数据缓存读未命中
+    COUNTER_DTLB_MISSES,          // 数据TLB读未命中
+    COUNTER_COUNT
+} bench_counter_t;
+
+static const char* const counter_names[COUNTER_COUNT] = { "LLC misses", "L1D read misses", "dTLB read misses" };
+static int counter_fds[COUNTER_COUNT];
+
+#ifdef __linux__
+// 打开一个只统计用户态的计数器（失败返回-1）
+static int counter_open(uint32_t type, uint64_t config)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+// 打开并清零全部计数器（不可用的计数器fd为-1）
+static void counters_start(void)
+{
+#ifdef __linux__
+    const uint64_t read_miss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    counter_fds[COUNTER_CACHE_MISSES] = counter_open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    counter_fds[COUNTER_L1D_MISSES] = counter_open(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | read_miss);
+    counter_fds[COUNTER_DTLB_MISSES] = counter_open(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | read_miss);
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        if (counter_fds[i] >= 0) {
+            ioctl(counter_fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counter_fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#else
+    for (int i = 0; i < COUNTER_COUNT; i++) counter_fds[i] = -1;
+#endif
+}
+
+// 停止计数器并打印每千条指令的未命中数
+static void counters_report(uint64_t instructions)
+{
+    int available = 0;
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        if (counter_fds[i] < 0) continue;
+#ifdef __linux__
+        uint64_t value = 0;
+        ioctl(counter_fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        if (read(counter_fds[i], &value, sizeof(value)) == (ssize_t)sizeof(value)) {
+            printf("  %-17s %.3f per 1000 instructions (%llu total)\n", counter_names[i],
+                value * 1000.0 / instructions, (unsigned long long)value);
+            available++;
+        }
+        close(counter_fds[i]);
+#endif
+    }
+    if (!available) {
+        printf("  hardware counters unavailable (need Linux perf_event_open permission)\n");
+    }
+}
+
+// 对照组：每个实例单独分配（按结构体对齐要求；分块前布局与原先一样使用calloc）
+static chip8_cpu_t* malloc_instance(void)
+{
+#if defined(CHIP8_LAYOUT_LEGACY)
+    return (chip8_cpu_t*)calloc(1, sizeof(chip8_cpu_t));
+#elif defined(_WIN32)
+    return (chip8_cpu_t*)_aligned_malloc(sizeof(chip8_cpu_t), CHIP8_CACHELINE);
+#else
+    return (chip8_cpu_t*)aligned_alloc(CHIP8_CACHELINE, sizeof(chip8_cpu_t));
+#endif
+}
+
+static void malloc_release(chip8_cpu_t* cpu)
+{
+#if defined(_WIN32) && !defined(CHIP8_LAYOUT_LEGACY)
+    _aligned_free(cpu);
+#else
+    free(cpu);
+#endif
+}
+
+// 释放前n个实例及实例表
+static void release_instances(chip8_cpu_t** instances, int n, int use_malloc)
+{
+    for (int i = 0; i < n; i++) {
+        if (use_malloc) malloc_release(instances[i]);
+        else slab_free(instances[i]);
+    }
+    free(instances);
+}
+
+// 多实例轮流执行基准
+int bench_instances(int count, int frames, int use_malloc, const chip8_backend_t* backend)
+{
+    chip8_cpu_t** instances = (chip8_cpu_t**)calloc(count, sizeof(chip8_cpu_t*));
+    if (!instances) {
+        fprintf(stderr, "Failed to allocate benchmark table\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // 1. 以当前实例为模板创建实例（各自不同的随机数种子）
+    chip8_cpu_t* template_cpu = CHIP8_CPU;
+    for (int i = 0; i < count; i++) {
+        instances[i] = use_malloc ? malloc_instance() : slab_alloc();
+        if (!instances[i]) {
+            fprintf(stderr, "Failed to allocate benchmark instance %d\n", i);
+            release_instances(instances, i, use_malloc);
+            return -1;
+        }
+        memcpy(instances[i], template_cpu, sizeof(chip8_cpu_t));
+        instances[i]->rng_state = template_cpu->rng_state + (uint32_t)i * 0x9E3779B9u;
+        if (!instances[i]->rng_state) instances[i]->rng_state = 1;
+    }
+    if (!use_malloc) slab_report();
+
+    // 2. 每帧轮流执行所有实例（与网格模式相同的调度方式，实例均复制自模板，每帧周期数相同）
+    int cycles_per_frame = (int)(template_cpu->cycles_per_frame * speed_coeff);
+    counters_start();
+    uint64_t start = SDL_GetPerformanceCounter(); // 墙钟时间（与回归测试一致，clock()在部分平台上粒度过粗）
+    for (int f = 0; f < frames; f++) {
+        for (int i = 0; i < count; i++) {
+            CHIP8_CPU = instances[i];
+            backend->run(cycles_per_frame);
+            CHIP8_CPU->draw_flag = 0;
+        }
+    }
+    double elapsed = (double)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+    CHIP8_CPU = template_cpu;
+    uint32_t divergences = lockstep_close(); // 实例释放前比对未结束的锁步窗口
+
+    uint64_t instructions = (uint64_t)count * frames * cycles_per_frame;
+    printf("Benchmark: %d instances x %d frames (%s layout, %zu bytes, %s, %s backend): %llu instructions, %.3f s, %.2f ns/instr\n",
+        count, frames, CHIP8_LAYOUT_NAME, sizeof(chip8_cpu_t), use_malloc ? "per-instance malloc" : "slab", backend->name,
+        (unsigned long long)instructions, elapsed, instructions ? elapsed * 1e9 / instructions : 0.0);
+    counters_report(instructions ? instructions : 1);
+
+    release_instances(instances, count, use_malloc);
+    return (divergences == 0) ? 0 : -1;
+}
@@ -0,0 +1,16 @@
+#ifndef CHIP8_BENCH_H_
+#define CHIP8_BENCH_H_
+
+#include "chip8_backend.h"
+
+// 基准测试参数
+#define BENCH_DEFAULT_FRAMES 600  // 默认运行帧数（60Hz下10秒）
+
+// 多实例基准：以CHIP8_CPU为模板复制出count个实例，每帧轮流执行每个实例
+// use_malloc为1时每个实例单独分配（对照组），否则从大页实例分配器分配
+// 对比结构体布局时以-DCHIP8_LAYOUT_LEGACY另行编译一份，分别运行（输出中注明布局）
+// Linux下通过perf_event_open统计缓存/TLB未命中（无权限时只报告耗时）
+// 返回0表示完成，实例分配失败或锁步校验出现分歧返回-1
+int bench_instances(int count, int frames, int use_malloc, const chip8_backend_t* backend);
+
+#endif
@@ -0,0 +1,344 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+#include "chip8_cpu.h"
+#include "chip8_capture.h"
+
+#define CAP_W 64
+#define CAP_H 32
+
+// 录制格式
+typedef enum {
+    CAPTURE_NONE = 0,
+    CAPTURE_Y4M,
+    CAPTURE_FRAMELOG
+} capture_format_t;
+
+// 缓冲池中的一帧
+typedef struct {
+    int screenshot;               // 1=PNG截图请求，0=录制帧
+    uint8_t video[CAP_W * CAP_H];
+} capture_slot_t;
+
+// 单生产者（帧循环）/单消费者（编码线程）环形队列，head/tail只增不减
+static capture_slot_t pool[CAPTURE_POOL_SIZE];
+static uint32_t queue_head = 0;   // 生产者写入位置（持锁发布）
+static uint32_t queue_tail = 0;   // 消费者读取位置（持锁发布）
+static SDL_mutex* queue_lock = NULL;
+static SDL_cond* queue_cond = NULL;
+static SDL_Thread* encoder_thread = NULL;
+static int encoder_stop = 0;
+
+static capture_format_t record_format = CAPTURE_NONE;
+static FILE* record_file = NULL;
+static uint32_t frames_written = 0;
+static uint32_t frames_dropped = 0;
+static uint32_t screenshot_count = 0;
+
+// 写一帧Y4M（编码线程中调用；亮度平面放大，色度平面固定128）
+static void write_y4m(const uint8_t* video)
+{
+    static uint8_t plane[CAP_W * CAPTURE_Y4M_SCALE * CAP_H * CAPTURE_Y4M_SCALE];
+    const int w = CAP_W * CAPTURE_Y4M_SCALE;
+    const int h = CAP_H * CAPTURE_Y4M_SCALE;
+
+    for (int y = 0; y < h; y++) {
+        const uint8_t* src = video + (y / CAPTURE_Y4M_SCALE) * CAP_W;
+        for (int x = 0; x < w; x++) {
+            plane[y * w + x] = src[x / CAPTURE_Y4M_SCALE] ? 255 : 0;
+        }
+    }
+    fputs("FRAME\n", record_file);
+    fwrite(plane, 1, w * h, record_file);
+
+    memset(plane, 128, (w / 2) * (h / 2));
+    fwrite(plane, 1, (w / 2) * (h / 2), record_file); // U
+    fwrite(plane, 1, (w / 2) * (h / 2), record_file); // V
+}
+
+// 写一帧1位/像素帧日志
+static void write_framelog(const uint8_t* video)
+{
+    uint8_t packed[CAP_W * CAP_H / 8];
+    for (int i = 0; i < (int)sizeof(packed); i++, video += 8) {
+        packed[i] = (uint8_t)((video[0] << 7) | (video[1] << 6) | (video[2] << 5) | (video[3] << 4) |
+            (video[4] << 3) | (video[5] << 2) | (video[6] << 1) | video[7]);
+    }
+    fwrite(packed, 1, sizeof(packed), record_file);
+}
+
+// CRC32（PNG块校验）
+static uint32_t crc32_update(uint32_t crc, const uint8_t* data, size_t len)
+{
+    static uint32_t table[256];
+    static int table_ready = 0;
+    if (!table_ready) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        table_ready = 1;
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+// 大端写入32位
+static void put_be32(uint8_t* p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+// 写一个PNG块（长度+类型+数据+CRC）
+static void png_chunk(FILE* f, const char* type, const uint8_t* data, uint32_t len)
+{
+    uint8_t buf[4];
+    put_be32(buf, len);
+    fwrite(buf, 1, 4, f);
+    fwrite(type, 1, 4, f);
+    if (len) fwrite(data, 1, len, f);
+    put_be32(buf, crc32_update(crc32_update(0, (const uint8_t*)type, 4), data, len));
+    fwrite(buf, 1, 4, f);
+}
+
+// 写PNG截图（1位灰度，zlib存储块无压缩，保证无损且无外部依赖）
+static void write_png(const uint8_t* video)
+{
+    enum {
+        W = CAP_W * CAPTURE_PNG_SCALE,
+        H = CAP_H * CAPTURE_PNG_SCALE,
+        ROW = 1 + W / 8,                   // 过滤字节 + 像素
+        RAW = ROW * H,
+        BLOCKS = (RAW + 65534) / 65535,
+        IDAT = 2 + RAW + BLOCKS * 5 + 4    // zlib头 + 数据 + 存储块头 + Adler32
+    };
+
+    char name[64];
+    snprintf(name, sizeof(name), "screenshot_%04u.png", screenshot_count++);
+    FILE* f = fopen(name, "wb");
+    if (!f) {
+        fprintf(stderr, "Failed to write screenshot: %s\n", name);
+        return;
+    }
+
+    static uint8_t raw[RAW];
+    static uint8_t idat[IDAT];
+
+    // 1. 扫描线（过滤类型0）
+    memset(raw, 0, sizeof(raw));
+    for (int y = 0; y < H; y++) {
+        uint8_t* row = raw + y * ROW;
+        const uint8_t* src = video + (y / CAPTURE_PNG_SCALE) * CAP_W;
+        for (int x = 0; x < W; x++) {
+            if (src[x / CAPTURE_PNG_SCALE]) row[1 + x / 8] |= (uint8_t)(0x80 >> (x % 8));
+        }
+    }
+
+    // 2. zlib封装：存储块 + Adler32
+    uint8_t* p = idat;
+    *p++ = 0x78;
+    *p++ = 0x01;
+    uint32_t a = 1, b = 0;
+    for (int off = 0; off < RAW;) {
+        int len = (RAW - off > 65535) ? 65535 : RAW - off;
+        *p++ = (off + len == RAW) ? 1 : 0;
+        *p++ = (uint8_t)len;
+        *p++ = (uint8_t)(len >> 8);
+        *p++ = (uint8_t)~len;
+        *p++ = (uint8_t)(~len >> 8);
+        memcpy(p, raw + off, len);
+        for (int i = 0; i < len; i++) {
+            a = (a + raw[off + i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        p += len;
+        off += len;
+    }
+    put_be32(p, (b << 16) | a);
+    p += 4;
+
+    // 3. 写文件
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    uint8_t ihdr[13];
+    put_be32(ihdr, W);
+    put_be32(ihdr + 4, H);
+    ihdr[8] = 1;   // 位深度
+    ihdr[9] = 0;   // 灰度
+    ihdr[10] = 0;  // deflate
+    ihdr[11] = 0;  // 标准过滤
+    ihdr[12] = 0;  // 无隔行
+    fwrite(signature, 1, sizeof(signature), f);
+    png_chunk(f, "IHDR", ihdr, sizeof(ihdr));
+    png_chunk(f, "IDAT", idat, (uint32_t)(p - idat));
+    png_chunk(f, "IEND", NULL, 0);
+    fclose(f);
+
+    printf("Screenshot saved: %s\n", name);
+}
+
+// 编码线程：取出队列中的帧并写入文件，队列空时等待
+static int encoder_main(void* arg)
+{
+    (void)arg;
+    SDL_LockMutex(queue_lock);
+    for (;;) {
+        while (queue_tail == queue_head && !encoder_stop) {
+            SDL_CondWait(queue_cond, queue_lock);
+        }
+        if (queue_tail == queue_head) break; // 已请求停止且队列已清空
+        capture_slot_t* slot = &pool[queue_tail % CAPTURE_POOL_SIZE];
+        SDL_UnlockMutex(queue_lock);
+
+        // 编码期间不持锁，帧循环可继续提交
+        if (slot->screenshot) {
+            write_png(slot->video);
+        }
+        else if (record_format == CAPTURE_Y4M) {
+            write_y4m(slot->video);
+            frames_written++;
+        }
+        else if (record_format == CAPTURE_FRAMELOG) {
+            write_framelog(slot->video);
+            frames_written++;
+        }
+
+        SDL_LockMutex(queue_lock);
+        queue_tail++;
+    }
+    SDL_UnlockMutex(queue_lock);
+    return 0;
+}
+
+// 启动编码线程（首次使用时）
+static int encoder_start(void)
+{
+    if (encoder_thread) return 0;
+
+    queue_lock = SDL_CreateMutex();
+    queue_cond = SDL_CreateCond();
+    encoder_stop = 0;
+    encoder_thread = (queue_lock && queue_cond) ? SDL_CreateThread(encoder_main, "chip8_capture", NULL) : NULL;
+    if (!encoder_thread) {
+        fprintf(stderr, "Capture thread create failed: %s\n", SDL_GetError());
+        return -1;
+    }
+    return 0;
+}
+
+// 提交一帧到缓冲池（池满时丢帧，不等待编码线程）
+static void submit(int screenshot)
+{
+    if (!encoder_thread || !CHIP8_CPU) return;
+
+    // 只有生产者修改queue_head，读取tail需持锁
+    SDL_LockMutex(queue_lock);
+    int full = (queue_head - queue_tail) >= CAPTURE_POOL_SIZE;
+    SDL_UnlockMutex(queue_lock);
+    if (full) {
+        frames_dropped++;
+        return;
+    }
+
+    capture_slot_t* slot = &pool[queue_head % CAPTURE_POOL_SIZE];
+    slot->screenshot = screenshot;
+    memcpy(slot->video, CHIP8_CPU->video, sizeof(slot->video));
+
+    SDL_LockMutex(queue_lock);
+    queue_head++;
+    SDL_CondSignal(queue_cond);
+    SDL_UnlockMutex(queue_lock);
+}
+
+// 开始录制
+int capture_open(const char* path)
+{
+    const char* ext = strrchr(path, '.');
+    if (ext && strcmp(ext, ".y4m") == 0) {
+        record_format = CAPTURE_Y4M;
+    }
+    else if (ext && strcmp(ext, ".c8v") == 0) {
+        record_format = CAPTURE_FRAMELOG;
+    }
+    else {
+        fprintf(stderr, "Unsupported capture format (use .y4m or .c8v): %s\n", path);
+        return -1;
+    }
+
+    record_file = fopen(path, "wb");
+    if (!record_file) {
+        fprintf(stderr, "Failed to open capture file: %s\n", path);
+        record_format = CAPTURE_NONE;
+        return -1;
+    }
+
+    frames_written = 0;
+    frames_dropped = 0;
+
+    // 写文件头
+    if (record_format == CAPTURE_Y4M) {
+        fprintf(record_file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n",
+            CAP_W * CAPTURE_Y4M_SCALE, CAP_H * CAPTURE_Y4M_SCALE, CAPTURE_FPS);
+    }
+    else {
+        const uint8_t header[10] = { 'C', '8', 'V', '1', CAP_W, 0, CAP_H, 0, CAPTURE_FPS, 0 };
+        fwrite(header, 1, sizeof(header), record_file);
+    }
+
+    if (encoder_start() != 0) {
+        fclose(record_file);
+        record_file = NULL;
+        record_format = CAPTURE_NONE;
+        return -1;
+    }
+
+    printf("Recording frames to %s\n", path);
+    return 0;
+}
+
+// 提交录制帧
+void capture_frame(void)
+{
+    if (record_format != CAPTURE_NONE) {
+        submit(0);
+    }
+}
+
+// 请求PNG截图
+void capture_screenshot(void)
+{
+    if (encoder_start() == 0) {
+        submit(1);
+    }
+}
+
+// 结束录制/截图线程
+void capture_close(void)
+{
+    if (!encoder_thread) return;
+
+    SDL_LockMutex(queue_lock);
+    encoder_stop = 1;
+    SDL_CondSignal(queue_cond);
+    SDL_UnlockMutex(queue_lock);
+    SDL_WaitThread(encoder_thread, NULL);
+    encoder_thread = NULL;
+
+    SDL_DestroyCond(queue_cond);
+    SDL_DestroyMutex(queue_lock);
+    queue_cond = NULL;
+    queue_lock = NULL;
+
+    if (record_file) {
+        fclose(record_file);
+        record_file = NULL;
+        printf("Capture finished: %u frames written, %u dropped\n", frames_written, frames_dropped);
+    }
+    record_format = CAPTURE_NONE;
+}
@@ -0,0 +1,23 @@
+#ifndef CHIP8_CAPTURE_H_
+#define CHIP8_CAPTURE_H_
+
+#include <stdint.h>
+
+// 采集参数
+#define CAPTURE_POOL_SIZE 64      // 帧缓冲池大小（编码线程落后超过此数量时丢帧）
+#define CAPTURE_Y4M_SCALE 4       // Y4M视频放大倍数（256x128）
+#define CAPTURE_PNG_SCALE 10      // PNG截图放大倍数（640x320）
+#define CAPTURE_FPS 60
+
+// 录制格式由文件扩展名决定：
+//   .y4m  原始YUV4MPEG2视频（C420jpeg，可直接管道给外部编码器）
+//   .c8v  紧凑帧日志：头部"C8V1" + uint16 宽/高/帧率（小端），之后每帧256字节（1位/像素，逐行，高位在左）
+// PNG截图（F12）写入当前目录 screenshot_NNNN.png
+
+// 采集函数声明
+int capture_open(const char* path);  // 开始录制（启动后台编码线程，失败返回-1）
+void capture_frame(void);            // 复制当前帧到缓冲池交给编码线程（从不阻塞，池满则丢帧）
+void capture_screenshot(void);       // 请求一张当前帧的PNG截图（同样异步）
+void capture_close(void);            // 写完队列中剩余帧，结束编码线程并输出统计
+
+#endif
@@ -5,11 +5,14 @@
 
 #include "chip8_cpu.h"
 #include "chip8_opcodes.h"
+#include "chip8_state.h"
+#include "chip8_slab.h"
+#include "chip8_backend.h"
 
 // 全局变量定义
 chip8_cpu_t* CHIP8_CPU = NULL;
 float speed_coeff = 1.0f;        // 速度系数（默认100%）
-int is_running = 1;              // 程序运行标记
+volatile sig_atomic_t is_running = 1; // 程序运行标记
 
 // CHIP-8内置字体集（0-F点阵）
 static const unsigned char FONTSET[80] =
@@ -32,36 +35,58 @@ static const unsigned char FONTSET[80] =
     0xF0, 0x80, 0xF0, 0x80, 0x80  // F
 };
 
-// 初始化CPU（首次启动，分配内存+加载字体）
-void init(void)
+// 创建独立CPU实例（分配内存+复位+加载字体）
+chip8_cpu_t* cpu_create(void)
 {
-    // 分配CPU内存
-    CHIP8_CPU = (chip8_cpu_t*)malloc(sizeof(chip8_cpu_t));
-    if (!CHIP8_CPU) {
+    // 从实例分配器取得缓存行对齐的内存（清零，保证未加载ROM的内存区域内容确定）
+    chip8_cpu_t* cpu = slab_alloc();
+    if (!cpu) {
         fprintf(stderr, "Failed to allocate CPU memory\n");
         exit(EXIT_FAILURE);
     }
 
-    // 重置CPU状态（复用reset逻辑）
+    // 重置CPU状态（复用reset逻辑，reset作用于CHIP8_CPU）
+    chip8_cpu_t* saved = CHIP8_CPU;
+    CHIP8_CPU = cpu;
     reset();
+    cpu_seed(1);
+    CHIP8_CPU = saved;
 
-    // 加载字体集到内存（仅首次初始化执行）
-    memcpy(CHIP8_CPU->memory + FONTSET_START_ADDR, FONTSET, sizeof(FONTSET));
+    // 加载字体集到内存（仅创建时执行）
+    memcpy(cpu->memory + FONTSET_START_ADDR, FONTSET, sizeof(FONTSET));
+    return cpu;
+}
+
+// 释放实例（cpu_create创建或state_map映射）
+void cpu_free(chip8_cpu_t* cpu)
+{
+    if (!cpu) return;
+    lockstep_sync(cpu);
+    if (state_unmap(cpu)) return; // 映射实例解除映射
+    slab_free(cpu);
+}
+
+// 初始化CPU（首次启动，创建全局实例）
+void init(void)
+{
+    CHIP8_CPU = cpu_create();
 
     // 初始化随机数种子
-    srand(time(NULL));
+    cpu_seed((uint32_t)time(NULL));
 }
 
 // 重置CPU（加载新ROM时调用，保留内存/字体，重置寄存器/定时器等）
 void reset(void)
 {
     if (!CHIP8_CPU) return;
+    lockstep_sync(CHIP8_CPU); // 锁步校验从复位后的状态重新开始
 
     // 重置核心硬件状态
     memset(CHIP8_CPU->registers, 0, sizeof(CHIP8_CPU->registers));
     memset(CHIP8_CPU->stack, 0, sizeof(CHIP8_CPU->stack));
     memset(CHIP8_CPU->video, 0, sizeof(CHIP8_CPU->video));
     memset(CHIP8_CPU->keypad, 0, sizeof(CHIP8_CPU->keypad));
+    memset(CHIP8_CPU->keymap, 0, sizeof(CHIP8_CPU->keymap));
 
     CHIP8_CPU->index = 0;
     CHIP8_CPU->pc = PROGRAM_START_ADDR;  // 程序计数器指向ROM起始地址
@@ -70,57 +95,46 @@ void reset(void)
     CHIP8_CPU->soundTimer = 0;
     CHIP8_CPU->opcode = 0;
     CHIP8_CPU->draw_flag = 1; // 重置后清屏
+    CHIP8_CPU->timer_ticks = 0; // 定时器相位归零，保证相同输入下重放结果一致
+    CHIP8_CPU->quirks = 0;
+    CHIP8_CPU->cycles_per_frame = BASE_CYCLES_PER_FRAME;
 }
 
 // 释放CPU内存
 void destroy(void)
 {
     if (CHIP8_CPU) {
-        free(CHIP8_CPU);
+        cpu_free(CHIP8_CPU);
         CHIP8_CPU = NULL;
     }
 }
 
-// 加载ROM文件到内存（0x200开始）
-int loadrom(const char* rom_path)
+// 设置随机数种子（xorshift32状态不能为0）
+void cpu_seed(uint32_t seed)
 {
-    if (!rom_path || !CHIP8_CPU) return -1;
-
-    FILE* rom_file = fopen(rom_path, "rb");
-    if (!rom_file) {
-        fprintf(stderr, "Failed to open ROM file: %s\n", rom_path);
-        return -1;
-    }
-
-    // 获取ROM大小
-    fseek(rom_file, 0, SEEK_END);
-    long rom_size = ftell(rom_file);
-    fseek(rom_file, 0, SEEK_SET);
-
-    // 检查ROM大小是否超出内存限制（0x200-0xFFF，共3840字节）
-    if (rom_size > (4096 - PROGRAM_START_ADDR)) {
-        fprintf(stderr, "ROM file too large (max size: %d bytes)\n", 4096 - PROGRAM_START_ADDR);
-        fclose(rom_file);
-        return -1;
-    }
-
-    // 读取ROM到内存（0x200开始）
-    size_t bytes_read = fread(CHIP8_CPU->memory + PROGRAM_START_ADDR, 1, rom_size, rom_file);
-    fclose(rom_file);
-
-    if (bytes_read != rom_size) {
-        fprintf(stderr, "Failed to read full ROM (read %zu/%ld bytes)\n", bytes_read, rom_size);
-        return -1;
-    }
+    CHIP8_CPU->rng_state = seed ? seed : 1;
+}
 
-    printf("Successfully loaded ROM: %s (size: %ld bytes)\n", rom_path, rom_size);
-    return 0;
+// 下一个随机数（xorshift32，状态保存在实例内）
+uint32_t cpu_random(void)
+{
+    uint32_t r = CHIP8_CPU->rng_state;
+    r ^= r << 13;
+    r ^= r >> 17;
+    r ^= r << 5;
+    CHIP8_CPU->rng_state = r;
+    return r;
 }
 
-// 定时器更新计数器（适配速度系数）
-static uint32_t timer_ticks = 0;
+// 定时器更新频率（计数器为每实例的timer_ticks，适配速度系数）
 #define BASE_TIMER_FREQ 60 // 基准定时器频率60Hz
 
+// 计算适配速度后的定时器更新阈值（BASE_TIMER_FREQ * speed_coeff，每帧周期数取当前实例的ROM配置）
+uint32_t timer_threshold(void)
+{
+    return (uint32_t)(CHIP8_CPU->cycles_per_frame * 60 / (BASE_TIMER_FREQ * speed_coeff));
+}
+
 // 执行一次CPU周期（取指→解码→执行→更新定时器）
 void cycle(void)
 {
@@ -134,10 +148,8 @@ void cycle(void)
     oc_exec();
 
     // 4. 更新定时器（按速度系数适配频率）
-    timer_ticks++;
-    // 计算适配速度后的定时器更新阈值（BASE_TIMER_FREQ * speed_coeff）
-    uint32_t timer_threshold = (uint32_t)(BASE_CYCLES_PER_FRAME * 60 / (BASE_TIMER_FREQ * speed_coeff));
-    if (timer_ticks >= timer_threshold) {
+    CHIP8_CPU->timer_ticks++;
+    if (CHIP8_CPU->timer_ticks >= timer_threshold()) {
         if (CHIP8_CPU->delayTimer > 0) {
             CHIP8_CPU->delayTimer--;
         }
@@ -147,6 +159,17 @@ void cycle(void)
             // 声音定时器>0时可触发蜂鸣（简化实现，注释掉避免依赖音频）
             // audio_beep();
         }
-        timer_ticks = 0;
+        CHIP8_CPU->timer_ticks = 0;
+    }
+}
+
+// FNV-1a 64位哈希（可分段累加）
+uint64_t fnv1a64(const void* data, size_t len, uint64_t hash)
+{
+    const uint8_t* p = (const uint8_t*)data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= 0x100000001b3ULL;
     }
+    return hash;
 }
@@ -2,6 +2,8 @@
 #define CHIP8_CPU_H_ 
 
 #include <stdint.h>
+#include <stddef.h>
+#include <signal.h>
 
 // 内存地址常量
 #define FONTSET_START_ADDR 0x000
@@ -9,7 +11,23 @@
 // 基准每帧执行周期数（对应540指令/秒，60Hz帧率）
 #define BASE_CYCLES_PER_FRAME 9
 
+// 兼容性开关（不同解释器对部分指令的行为差异，按ROM配置）
+#define QUIRK_SHIFT_VY 0x01          // 8xy6/8xyE：先将Vy复制到Vx再移位（COSMAC VIP）
+#define QUIRK_LOADSTORE_KEEP_I 0x02  // Fx55/Fx65：执行后不修改I（SUPER-CHIP）
+#define QUIRK_JUMP_VX 0x04           // Bxnn：跳转到Vx+xnn而不是V0+xnn（SUPER-CHIP）
+
+// 缓存行对齐（CPU实例及其内部分块按64字节对齐）
+#define CHIP8_CACHELINE 64
+#if defined(_MSC_VER)
+#define CHIP8_ALIGNED(n) __declspec(align(n))
+#else
+#define CHIP8_ALIGNED(n) __attribute__((aligned(n)))
+#endif
+
 // CHIP-8 CPU核心结构体
+// 编译时定义CHIP8_LAYOUT_LEGACY可切换回分块前的字段顺序（不按缓存行对齐），用于--bench-instances对比布局效果
+#ifdef CHIP8_LAYOUT_LEGACY
+#define CHIP8_LAYOUT_NAME "legacy"
 typedef struct {
     uint8_t registers[16];        // V0-VF通用寄存器
     uint8_t memory[4096];         // 4KB内存
@@ -20,21 +38,65 @@ typedef struct {
     uint8_t delayTimer;           // 延迟定时器
     uint8_t soundTimer;           // 声音定时器
     uint8_t keypad[16];           // 16键键盘映射
-    uint8_t video[64 * 32];         // 64x32显示缓冲区
+    uint8_t video[64 * 32];       // 64x32显示缓冲区
     uint16_t opcode;              // 当前执行的16位指令
     int draw_flag;                // 屏幕刷新标记
+    uint32_t timer_ticks;         // 定时器更新计数器（每实例独立）
+    uint8_t quirks;               // 兼容性开关（QUIRK_*，reset时清零）
+    uint32_t rng_state;           // Cxnn随机数发生器状态（每实例独立，便于重放与比对）
+    uint32_t cycles_per_frame;    // 100%速度时每帧执行周期数
+    char keymap[16];              // CHIP-8键0-F对应的按键名字符
+} chip8_cpu_t;
+#else
+#define CHIP8_LAYOUT_NAME "hot/cold split"
+// 按访问频率分块：每条指令都会访问的寄存器状态集中在第一个缓存行，
+// 其后依次为栈/键盘（子程序调用与按键指令）、内存、显示缓冲区（仅绘制指令）
+typedef struct CHIP8_ALIGNED(CHIP8_CACHELINE) {
+    // 热数据（1个缓存行）
+    uint8_t registers[16];        // V0-VF通用寄存器
+    uint16_t pc;                  // 程序计数器
+    uint16_t index;               // 索引寄存器I
+    uint16_t opcode;              // 当前执行的16位指令
+    uint8_t sp;                   // 栈指针
+    uint8_t delayTimer;           // 延迟定时器
+    uint8_t soundTimer;           // 声音定时器
+    uint8_t draw_flag;            // 屏幕刷新标记
+    uint8_t quirks;               // 兼容性开关（QUIRK_*，reset时清零）
+    uint32_t cycles_per_frame;    // 100%速度时每帧执行周期数（reset时为BASE_CYCLES_PER_FRAME，按ROM配置）
+    uint32_t timer_ticks;         // 定时器更新计数器（每实例独立）
+    uint32_t rng_state;           // Cxnn随机数发生器状态（每实例独立，便于重放与比对）
+
+    // 温数据
+    CHIP8_ALIGNED(CHIP8_CACHELINE) uint16_t stack[16]; // 栈（子程序返回地址）
+    uint8_t keypad[16];           // 16键键盘映射
+    char keymap[16];              // CHIP-8键0-F对应的按键名字符（ROM配置，首字节为0表示默认键位）
+
+    // 冷数据
+    CHIP8_ALIGNED(CHIP8_CACHELINE) uint8_t memory[4096]; // 4KB内存
+    uint8_t video[64 * 32];       // 64x32显示缓冲区
 } chip8_cpu_t;
+// 新增热字段时保证热数据仍只占1个缓存行
+_Static_assert(offsetof(chip8_cpu_t, stack) == CHIP8_CACHELINE, "chip8_cpu_t hot fields must fit in one cache line");
+#endif
 
 // 全局变量声明
 extern chip8_cpu_t* CHIP8_CPU;
 extern float speed_coeff;        // 速度系数（0.5-2.0，1.0=100%基准速度）
-extern int is_running;           // 程序运行标记
+extern volatile sig_atomic_t is_running; // 程序运行标记（SIGINT处理函数中清零）
 
 // 核心函数声明
-int loadrom(const char* rom);    // 加载ROM文件
 void init(void);                 // 初始化CPU（首次启动）
 void reset(void);                // 重置CPU（加载新ROM时）
 void destroy(void);              // 释放CPU内存
 void cycle(void);                // 执行一次CPU周期
+chip8_cpu_t* cpu_create(void);   // 创建独立CPU实例（已加载字体并复位，多实例运行时切换CHIP8_CPU使用）
+void cpu_free(chip8_cpu_t* cpu); // 释放实例（cpu_create创建或state_map映射）
+void cpu_seed(uint32_t seed);    // 设置CHIP8_CPU的随机数种子
+uint32_t cpu_random(void);       // CHIP8_CPU的下一个随机数（xorshift32）
+uint32_t timer_threshold(void);  // 当前速度下定时器每次递减所需的周期数
+
+// 工具函数
+uint64_t fnv1a64(const void* data, size_t len, uint64_t hash); // FNV-1a 64位哈希（hash传入FNV1A64_INIT或上一段结果）
+#define FNV1A64_INIT 0xcbf29ce484222325ULL
 
 #endif
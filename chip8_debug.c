@@ -0,0 +1,429 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "chip8_cpu.h"
+#include "chip8_debug.h"
+
+// 全局变量定义
+int debug_attached = 0;
+int debug_watch_enabled = 0;
+uint8_t debug_watch_map[DEBUG_MEMORY_SIZE / 8];
+
+// 断点条件比较运算
+typedef enum {
+    COND_NONE = 0,
+    COND_EQ,
+    COND_NE,
+    COND_LT,
+    COND_GT,
+    COND_LE,
+    COND_GE
+} cond_op_t;
+
+// 断点（PC地址 + 可选寄存器条件，如"V3 == 5"或"I >= 0x300"）
+typedef struct {
+    int used;
+    uint16_t addr;
+    cond_op_t op;
+    int reg;                      // 0-15为Vx，16为索引寄存器I
+    int value;
+} breakpoint_t;
+
+// 调试器运行状态
+typedef enum {
+    DBG_RUN = 0,                  // 连续运行直到断点/观察点
+    DBG_PAUSED,                   // 暂停，等待控制台命令
+    DBG_STEP,                     // 单步执行step_left条指令
+    DBG_STEP_OVER,                // 单步跳过子程序调用（2nnn）
+    DBG_FINISH                    // 执行到当前子程序返回（00EE）
+} dbg_mode_t;
+
+#define REG_INDEX 16
+
+static breakpoint_t breakpoints[DEBUG_MAX_BREAKPOINTS];
+static uint8_t bp_map[DEBUG_MEMORY_SIZE / 8];   // PC断点位图（快速判断）
+static dbg_mode_t dbg_mode = DBG_PAUSED;
+static int step_left = 0;
+static uint8_t target_sp = 0;                   // 跳过/跳出时的目标栈深度
+static int skip_bp_once = 0;                    // 恢复运行时跳过当前PC上的断点
+static int watch_hit = 0;                       // 本条指令命中观察点
+static uint16_t watch_hit_addr = 0;
+static uint32_t instr_count = 0;                // 调试器挂载后已执行的指令数
+
+#define BIT_TEST(map, a) ((map)[((a) & 0xFFF) >> 3] & (1 << ((a) & 7)))
+#define BIT_SET(map, a) ((map)[((a) & 0xFFF) >> 3] |= (uint8_t)(1 << ((a) & 7)))
+#define BIT_CLEAR(map, a) ((map)[((a) & 0xFFF) >> 3] &= (uint8_t)~(1 << ((a) & 7)))
+
+// 挂载调试器（启动后暂停在第一条指令）
+void debug_attach(void)
+{
+    debug_attached = 1;
+    dbg_mode = DBG_PAUSED;
+    printf("[DEBUG] Debugger attached - type 'h' for help\n");
+}
+
+// 检查写入范围是否命中观察点（由oc_fx33/oc_fx55调用）
+void debug_watch_check(uint16_t addr, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; i++) {
+        if (BIT_TEST(debug_watch_map, addr + i)) {
+            watch_hit = 1;
+            watch_hit_addr = (addr + i) & 0xFFF;
+            return;
+        }
+    }
+}
+
+// 重新计算是否存在观察点（决定写指令中的检查是否生效）
+static void watch_refresh(void)
+{
+    debug_watch_enabled = 0;
+    for (size_t i = 0; i < sizeof(debug_watch_map); i++) {
+        if (debug_watch_map[i]) {
+            debug_watch_enabled = 1;
+            return;
+        }
+    }
+}
+
+// 重新生成PC断点位图
+static void bp_refresh(void)
+{
+    memset(bp_map, 0, sizeof(bp_map));
+    for (int i = 0; i < DEBUG_MAX_BREAKPOINTS; i++) {
+        if (breakpoints[i].used) {
+            BIT_SET(bp_map, breakpoints[i].addr);
+        }
+    }
+}
+
+// 读取条件中的寄存器值
+static int reg_value(int reg)
+{
+    return (reg == REG_INDEX) ? CHIP8_CPU->index : CHIP8_CPU->registers[reg];
+}
+
+// 判断断点条件是否成立
+static int cond_met(const breakpoint_t* bp)
+{
+    int v = reg_value(bp->reg);
+    switch (bp->op) {
+    case COND_EQ: return v == bp->value;
+    case COND_NE: return v != bp->value;
+    case COND_LT: return v < bp->value;
+    case COND_GT: return v > bp->value;
+    case COND_LE: return v <= bp->value;
+    case COND_GE: return v >= bp->value;
+    default: return 1;
+    }
+}
+
+// 当前PC是否命中断点（返回断点编号，未命中返回-1）
+static int bp_hit(uint16_t pc)
+{
+    if (!BIT_TEST(bp_map, pc)) return -1;
+    for (int i = 0; i < DEBUG_MAX_BREAKPOINTS; i++) {
+        if (breakpoints[i].used && breakpoints[i].addr == pc && cond_met(&breakpoints[i])) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// 打印寄存器状态
+static void print_regs(void)
+{
+    uint16_t op = (CHIP8_CPU->memory[CHIP8_CPU->pc & 0xFFF] << 8) | CHIP8_CPU->memory[(CHIP8_CPU->pc + 1) & 0xFFF];
+    printf("PC=%03X [%04X]  I=%03X  SP=%X  DT=%02X  ST=%02X  count=%u\n",
+        CHIP8_CPU->pc, op, CHIP8_CPU->index, CHIP8_CPU->sp,
+        CHIP8_CPU->delayTimer, CHIP8_CPU->soundTimer, instr_count);
+    for (int i = 0; i < 16; i++) {
+        printf("V%X=%02X%s", i, CHIP8_CPU->registers[i], (i % 8 == 7) ? "\n" : "  ");
+    }
+    for (int i = 0; i < CHIP8_CPU->sp; i++) {
+        printf("  stack[%d]=%03X\n", i, CHIP8_CPU->stack[i]);
+    }
+}
+
+// 打印内存内容
+static void print_memory(uint16_t addr, int len)
+{
+    for (int i = 0; i < len; i++) {
+        if (i % 16 == 0) printf("%s%03X:", i ? "\n" : "", (addr + i) & 0xFFF);
+        printf(" %02X", CHIP8_CPU->memory[(addr + i) & 0xFFF]);
+    }
+    printf("\n");
+}
+
+// 打印帮助信息
+static void print_help(void)
+{
+    printf("Commands (addresses in hex, values decimal or 0x..):\n"
+        "  c                      continue\n"
+        "  s [n]                  step n instructions (default 1)\n"
+        "  n                      step over subroutine call (2nnn)\n"
+        "  f                      run until current subroutine returns (00EE)\n"
+        "  b <addr> [if <reg> <op> <value>]  set breakpoint, reg=V0-VF|I, op=== != < > <= >=\n"
+        "  d <id>                 delete breakpoint\n"
+        "  bl                     list breakpoints\n"
+        "  w <addr> [len]         set memory watchpoint (Fx33/Fx55 writes)\n"
+        "  uw <addr> [len]        remove memory watchpoint\n"
+        "  r                      show registers\n"
+        "  x <addr> [len]         dump memory\n"
+        "  q                      quit emulator\n");
+}
+
+// 解析条件运算符
+static cond_op_t parse_op(const char* s)
+{
+    if (strcmp(s, "==") == 0) return COND_EQ;
+    if (strcmp(s, "!=") == 0) return COND_NE;
+    if (strcmp(s, "<") == 0) return COND_LT;
+    if (strcmp(s, ">") == 0) return COND_GT;
+    if (strcmp(s, "<=") == 0) return COND_LE;
+    if (strcmp(s, ">=") == 0) return COND_GE;
+    return COND_NONE;
+}
+
+// 解析寄存器名（V0-VF或I）
+static int parse_reg(const char* s)
+{
+    if ((s[0] == 'I' || s[0] == 'i') && s[1] == '\0') return REG_INDEX;
+    if ((s[0] == 'V' || s[0] == 'v') && isxdigit((unsigned char)s[1]) && s[2] == '\0') {
+        return (int)strtol(s + 1, NULL, 16);
+    }
+    return -1;
+}
+
+// 设置断点：b <addr> [if <reg> <op> <value>]
+static void cmd_break(char* args)
+{
+    char* tok = strtok(args, " \t");
+    if (!tok) {
+        printf("usage: b <addr> [if <reg> <op> <value>]\n");
+        return;
+    }
+
+    breakpoint_t bp = { 1, (uint16_t)(strtol(tok, NULL, 16) & 0xFFF), COND_NONE, 0, 0 };
+    char* kw = strtok(NULL, " \t");
+    if (kw) {
+        char* reg = strtok(NULL, " \t");
+        char* op = strtok(NULL, " \t");
+        char* val = strtok(NULL, " \t");
+        if (strcmp(kw, "if") != 0 || !reg || !op || !val ||
+            (bp.reg = parse_reg(reg)) < 0 || (bp.op = parse_op(op)) == COND_NONE) {
+            printf("bad condition, expected: if <V0-VF|I> <op> <value>\n");
+            return;
+        }
+        bp.value = (int)strtol(val, NULL, 0);
+    }
+
+    for (int i = 0; i < DEBUG_MAX_BREAKPOINTS; i++) {
+        if (!breakpoints[i].used) {
+            breakpoints[i] = bp;
+            bp_refresh();
+            printf("breakpoint %d at %03X\n", i, bp.addr);
+            return;
+        }
+    }
+    printf("too many breakpoints (max %d)\n", DEBUG_MAX_BREAKPOINTS);
+}
+
+// 列出断点
+static void cmd_list(void)
+{
+    static const char* op_names[] = { "", "==", "!=", "<", ">", "<=", ">=" };
+    for (int i = 0; i < DEBUG_MAX_BREAKPOINTS; i++) {
+        const breakpoint_t* bp = &breakpoints[i];
+        if (!bp->used) continue;
+        if (bp->op == COND_NONE) {
+            printf("  %d: %03X\n", i, bp->addr);
+        }
+        else if (bp->reg == REG_INDEX) {
+            printf("  %d: %03X if I %s %d\n", i, bp->addr, op_names[bp->op], bp->value);
+        }
+        else {
+            printf("  %d: %03X if V%X %s %d\n", i, bp->addr, bp->reg, op_names[bp->op], bp->value);
+        }
+    }
+}
+
+// 设置/清除观察点：w|uw <addr> [len]
+static void cmd_watch(char* args, int set)
+{
+    char* tok = strtok(args, " \t");
+    if (!tok) {
+        printf("usage: %s <addr> [len]\n", set ? "w" : "uw");
+        return;
+    }
+    uint16_t addr = (uint16_t)(strtol(tok, NULL, 16) & 0xFFF);
+    char* len_tok = strtok(NULL, " \t");
+    int len = len_tok ? (int)strtol(len_tok, NULL, 0) : 1;
+    if (len <= 0 || addr + len > DEBUG_MEMORY_SIZE) {
+        printf("watch range must be 1..%d bytes inside 000-FFF\n", DEBUG_MEMORY_SIZE - addr);
+        return;
+    }
+
+    for (int i = 0; i < len; i++) {
+        if (set) BIT_SET(debug_watch_map, addr + i);
+        else BIT_CLEAR(debug_watch_map, addr + i);
+    }
+    watch_refresh();
+    printf("watchpoint %s %03X-%03X\n", set ? "set" : "cleared", addr, addr + len - 1);
+}
+
+// 控制台交互（逐行读取stdin命令，直到执行类命令恢复运行）
+static void debug_prompt(void)
+{
+    char line[128];
+
+    print_regs();
+    for (;;) {
+        printf("(c8db) ");
+        fflush(stdout);
+
+        if (!fgets(line, sizeof(line), stdin)) {
+            // stdin关闭：卸载调试器，继续正常运行
+            printf("\n[DEBUG] stdin closed, detaching debugger\n");
+            debug_attached = 0;
+            dbg_mode = DBG_RUN;
+            return;
+        }
+
+        line[strcspn(line, "\r\n")] = '\0';
+        char* cmd = strtok(line, " \t");
+        char* args = strtok(NULL, "");
+        if (!args) args = "";
+        if (!cmd) continue;
+
+        if (strcmp(cmd, "c") == 0) {
+            dbg_mode = DBG_RUN;
+            return;
+        }
+        else if (strcmp(cmd, "s") == 0) {
+            step_left = (*args) ? (int)strtol(args, NULL, 0) : 1;
+            if (step_left < 1) step_left = 1;
+            dbg_mode = DBG_STEP;
+            return;
+        }
+        else if (strcmp(cmd, "n") == 0) {
+            uint16_t op = (CHIP8_CPU->memory[CHIP8_CPU->pc & 0xFFF] << 8) | CHIP8_CPU->memory[(CHIP8_CPU->pc + 1) & 0xFFF];
+            if ((op & 0xF000) == 0x2000) {
+                target_sp = CHIP8_CPU->sp;    // 调用返回后栈深度恢复
+                dbg_mode = DBG_STEP_OVER;
+            }
+            else {
+                step_left = 1;
+                dbg_mode = DBG_STEP;
+            }
+            return;
+        }
+        else if (strcmp(cmd, "f") == 0) {
+            if (CHIP8_CPU->sp == 0) {
+                printf("not inside a subroutine\n");
+                continue;
+            }
+            target_sp = CHIP8_CPU->sp - 1;    // 00EE返回后栈深度减1
+            dbg_mode = DBG_FINISH;
+            return;
+        }
+        else if (strcmp(cmd, "b") == 0) {
+            cmd_break(args);
+        }
+        else if (strcmp(cmd, "d") == 0) {
+            int id = (int)strtol(args, NULL, 0);
+            if (id >= 0 && id < DEBUG_MAX_BREAKPOINTS && breakpoints[id].used) {
+                breakpoints[id].used = 0;
+                bp_refresh();
+                printf("breakpoint %d deleted\n", id);
+            }
+            else {
+                printf("no breakpoint %d\n", id);
+            }
+        }
+        else if (strcmp(cmd, "bl") == 0) {
+            cmd_list();
+        }
+        else if (strcmp(cmd, "w") == 0) {
+            cmd_watch(args, 1);
+        }
+        else if (strcmp(cmd, "uw") == 0) {
+            cmd_watch(args, 0);
+        }
+        else if (strcmp(cmd, "r") == 0) {
+            print_regs();
+        }
+        else if (strcmp(cmd, "x") == 0) {
+            char* tok = strtok(args, " \t");
+            char* len_tok = strtok(NULL, " \t");
+            uint16_t addr = tok ? (uint16_t)strtol(tok, NULL, 16) : CHIP8_CPU->index;
+            print_memory(addr, len_tok ? (int)strtol(len_tok, NULL, 0) : 16);
+        }
+        else if (strcmp(cmd, "q") == 0) {
+            is_running = 0;
+            dbg_mode = DBG_RUN;
+            return;
+        }
+        else if (strcmp(cmd, "h") == 0) {
+            print_help();
+        }
+        else {
+            printf("unknown command '%s' (type 'h' for help)\n", cmd);
+        }
+    }
+}
+
+// 调试运行循环（替代main中的cycle()循环，cycle()本身不含任何调试代码）
+void debug_run(int cycles)
+{
+    int i;
+    for (i = 0; i < cycles && is_running && debug_attached; i++) {
+        // 1. 执行前检查：暂停状态或命中断点则进入控制台
+        if (dbg_mode == DBG_PAUSED) {
+            debug_prompt();
+            skip_bp_once = 1;
+            if (!is_running || !debug_attached) break;
+        }
+        if (!skip_bp_once) {
+            int id = bp_hit(CHIP8_CPU->pc);
+            if (id >= 0) {
+                printf("[DEBUG] Breakpoint %d hit at %03X\n", id, CHIP8_CPU->pc);
+                debug_prompt();
+                if (!is_running || !debug_attached) break;
+            }
+        }
+        skip_bp_once = 0;
+
+        // 2. 执行一条指令
+        cycle();
+        instr_count++;
+
+        // 3. 执行后检查：观察点与单步条件
+        if (watch_hit) {
+            watch_hit = 0;
+            printf("[DEBUG] Watchpoint hit: write to %03X = %02X (opcode %04X)\n",
+                watch_hit_addr, CHIP8_CPU->memory[watch_hit_addr], CHIP8_CPU->opcode);
+            dbg_mode = DBG_PAUSED;
+            continue;
+        }
+
+        switch (dbg_mode) {
+        case DBG_STEP:
+            if (--step_left <= 0) dbg_mode = DBG_PAUSED;
+            break;
+        case DBG_STEP_OVER:
+        case DBG_FINISH:
+            if (CHIP8_CPU->sp == target_sp) dbg_mode = DBG_PAUSED;
+            break;
+        default:
+            break;
+        }
+    }
+
+    // 帧中途脱离调试器时，本帧剩余周期照常执行（不丢失周期预算）
+    for (; i < cycles && is_running; i++) {
+        cycle();
+    }
+}
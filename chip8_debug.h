@@ -0,0 +1,24 @@
+#ifndef CHIP8_DEBUG_H_
+#define CHIP8_DEBUG_H_
+
+#include <stdint.h>
+
+// 调试器参数
+#define DEBUG_MAX_BREAKPOINTS 32  // 最多断点数
+#define DEBUG_MEMORY_SIZE 4096    // 观察点位图覆盖的地址范围
+
+// 全局变量声明
+extern int debug_attached;                          // 调试器挂载标记（main据此选择运行循环）
+extern int debug_watch_enabled;                     // 存在内存观察点时置1
+extern uint8_t debug_watch_map[DEBUG_MEMORY_SIZE / 8]; // 观察点位图（每地址1位）
+
+// 内存写入检查（仅在写内存的指令处理函数中调用，无观察点时只有一次判断）
+#define DEBUG_WATCH_CHECK(addr, len) \
+    do { if (debug_watch_enabled) debug_watch_check((addr), (len)); } while (0)
+
+// 调试器函数声明
+void debug_attach(void);                            // 挂载调试器（启动后暂停在第一条指令）
+void debug_run(int cycles);                         // 调试运行循环（断点/观察点/单步）
+void debug_watch_check(uint16_t addr, uint16_t len); // 检查写入范围是否命中观察点
+
+#endif
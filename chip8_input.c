@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "chip8_cpu.h"
+#include "chip8_input.h"
+
+// 全局变量定义
+int input_subframe = 1;
+int input_probe = 0;
+
+// 排队的按键变化
+typedef struct {
+    uint32_t timestamp;           // SDL事件时间戳（毫秒）
+    uint8_t key;                  // 按键0-F
+    uint8_t pressed;              // 1=按下，0=释放
+} input_event_t;
+
+static input_event_t queue[INPUT_QUEUE_SIZE];
+static int queue_head = 0;        // 下一个待投递事件
+static int queue_count = 0;
+
+// 延迟探针状态（时间均为主机毫秒，指令时刻按其在帧窗口内的位置线性换算）
+static double window_ms = 0.0;    // 当前窗口起点
+static double cycle_ms = 0.0;     // 每条指令对应的主机毫秒
+static int window_done = 0;       // 当前窗口已执行的指令数
+static double press_time[16];     // 未被读取的按下事件的主机时间戳（<0表示无）
+static int press_seen[16];        // 本次按下期间ROM是否读过该键
+static uint32_t presses = 0;
+static uint32_t presses_missed = 0;
+static uint32_t latency_count = 0;
+static double latency_sum = 0.0;
+static double latency_max = 0.0;
+static uint32_t delivered = 0;
+static double error_sum = 0.0;    // 投递时刻与事件时间戳之差
+static double error_max = 0.0;
+static int probe_ready = 0;
+
+// 事件时间戳对应的批次内周期偏移（早于窗口的排在开头，晚于窗口的排在末尾）
+static int event_offset(uint32_t timestamp, int cycles, uint32_t window_start, uint32_t window_end)
+{
+    int32_t span = (int32_t)(window_end - window_start);
+    int32_t delta = (int32_t)(timestamp - window_start);
+    if (!input_subframe || span <= 0 || delta <= 0) return 0;
+    if (delta >= span) return cycles;
+    return (int)(((int64_t)delta * cycles + span / 2) / span); // 取最近的指令边界
+}
+
+// 记录ROM读取按键（按下后首次读取计入延迟）
+static void probe_read(int key)
+{
+    if (!CHIP8_CPU->keypad[key]) return;
+    press_seen[key] = 1;
+    if (press_time[key] >= 0.0) {
+        double latency = window_ms + window_done * cycle_ms - press_time[key];
+        latency_sum += latency;
+        if (latency > latency_max) latency_max = latency;
+        latency_count++;
+        press_time[key] = -1.0;
+    }
+}
+
+// 探针运行循环：逐条执行并识别读取按键的指令（Ex9E/ExA1读Vx键，Fx0A读全部按键）
+static void probe_run(void (*run)(int), int cycles)
+{
+    for (int i = 0; i < cycles; i++) {
+        run(1);
+        window_done++;
+
+        uint16_t op = CHIP8_CPU->opcode;
+        uint8_t vx = CHIP8_CPU->registers[(op & 0x0F00) >> 8];
+        if ((op & 0xF0FF) == 0xE09E || (op & 0xF0FF) == 0xE0A1) {
+            if (vx < 16) probe_read(vx);
+        }
+        else if ((op & 0xF0FF) == 0xF00A) {
+            for (int k = 0; k < 16; k++) probe_read(k);
+        }
+    }
+}
+
+// 执行一段指令
+static void run_segment(void (*run)(int), int cycles)
+{
+    if (cycles <= 0) return;
+    if (input_probe) {
+        probe_run(run, cycles);
+    }
+    else {
+        run(cycles);
+    }
+}
+
+// 投递一个按键变化（探针开启时记录投递误差与按下/释放）
+static void apply_event(const input_event_t* ev)
+{
+    CHIP8_CPU->keypad[ev->key] = ev->pressed;
+    if (!input_probe) return;
+
+    double error = window_ms + window_done * cycle_ms - ev->timestamp;
+    if (error < 0.0) error = -error;
+    delivered++;
+    error_sum += error;
+    if (error > error_max) error_max = error;
+
+    if (ev->pressed) {
+        presses++;
+        press_time[ev->key] = ev->timestamp;
+        press_seen[ev->key] = 0;
+    }
+    else {
+        if (!press_seen[ev->key]) presses_missed++;
+        press_time[ev->key] = -1.0;
+        press_seen[ev->key] = 1; // 重复释放不再计数
+    }
+}
+
+// 按键变化入队
+void input_queue_key(uint32_t timestamp, uint8_t key, uint8_t pressed)
+{
+    // 队满时先按顺序投递全部已排队事件（退化为帧边界投递，但不改变事件顺序）
+    if (queue_count == INPUT_QUEUE_SIZE) {
+        while (queue_count > 0) {
+            apply_event(&queue[queue_head]);
+            queue_head = (queue_head + 1) % INPUT_QUEUE_SIZE;
+            queue_count--;
+        }
+    }
+    input_event_t* ev = &queue[(queue_head + queue_count) % INPUT_QUEUE_SIZE];
+    ev->timestamp = timestamp;
+    ev->key = key;
+    ev->pressed = pressed;
+    queue_count++;
+}
+
+// 分段执行一帧：在每个按键事件对应的周期偏移处暂停并投递
+void input_run_frame(void (*run)(int), int cycles, uint32_t window_start, uint32_t window_end)
+{
+    if (input_probe) {
+        if (!probe_ready) {
+            for (int k = 0; k < 16; k++) {
+                press_time[k] = -1.0;
+                press_seen[k] = 1;
+            }
+            probe_ready = 1;
+        }
+        // 帧内投递时批次对应上一帧间隔；帧边界投递时批次对应即将开始的一帧（与旧行为一致）
+        window_ms = input_subframe ? window_start : window_end;
+        cycle_ms = (cycles > 0 && window_end > window_start) ? (double)(window_end - window_start) / cycles : 0.0;
+        window_done = 0;
+    }
+
+    // 无排队事件时整批执行（与逐帧执行完全相同）
+    int done = 0;
+    while (queue_count > 0) {
+        const input_event_t* ev = &queue[queue_head];
+        int offset = event_offset(ev->timestamp, cycles, window_start, window_end);
+        if (offset > done) {
+            run_segment(run, offset - done);
+            done = offset;
+        }
+        apply_event(ev);
+        queue_head = (queue_head + 1) % INPUT_QUEUE_SIZE;
+        queue_count--;
+    }
+    run_segment(run, cycles - done);
+}
+
+// 打印延迟统计
+void input_probe_report(void)
+{
+    if (!input_probe) return;
+
+    printf("Input probe (%s delivery): %u key presses, %u never read by the ROM\n",
+        input_subframe ? "sub-frame" : "frame-boundary", presses, presses_missed);
+    if (delivered > 0) {
+        printf("  delivery error: avg %.2f ms, max %.2f ms (%u events)\n", error_sum / delivered, error_max, delivered);
+    }
+    if (latency_count > 0) {
+        printf("  press-to-read latency: avg %.2f ms, max %.2f ms (%u reads)\n",
+            latency_sum / latency_count, latency_max, latency_count);
+    }
+}
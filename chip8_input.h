@@ -0,0 +1,21 @@
+#ifndef CHIP8_INPUT_H_
+#define CHIP8_INPUT_H_
+
+#include <stdint.h>
+
+// 输入队列参数
+#define INPUT_QUEUE_SIZE 64       // 每帧最多排队的按键变化（队满时已排队事件按顺序立即生效）
+
+// 帧内按键投递：
+// 每帧的周期批次对应上一帧间隔[window_start, window_end)的主机时间，
+// 按键事件按SDL时间戳换算为批次内的周期偏移，在对应指令之前生效（整体固定滞后一帧，
+// 同一帧内的多次按下/释放不再合并，Ex9E/ExA1/Fx0A看到的按键时序与实际一致）
+extern int input_subframe;        // 1=帧内投递（默认），0=帧边界投递（旧行为，用于对比）
+extern int input_probe;           // 1=统计按键延迟与ROM未读到的按键
+
+// 输入函数声明
+void input_queue_key(uint32_t timestamp, uint8_t key, uint8_t pressed); // 按键变化入队（时间戳为SDL毫秒）
+void input_run_frame(void (*run)(int), int cycles, uint32_t window_start, uint32_t window_end); // 分段执行一帧并投递按键
+void input_probe_report(void);    // 打印延迟统计（input_probe开启时）
+
+#endif
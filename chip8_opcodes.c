@@ -3,6 +3,7 @@
 #include <string.h>
 #include "chip8_cpu.h"
 #include "chip8_opcodes.h"
+#include "chip8_debug.h"
 
 // 辅助宏：快速提取指令中的位段
 #define Vx (CHIP8_CPU->registers[(CHIP8_CPU->opcode & 0x0F00) >> 8])
@@ -178,6 +179,7 @@ void oc_8xy5(void) {
 
 // 8xy6: Vx >>= 1 (保留最低位到VF)
 void oc_8xy6(void) {
+    if (CHIP8_CPU->quirks & QUIRK_SHIFT_VY) Vx = Vy;
     CHIP8_CPU->registers[0xF] = Vx & 0x01;
     Vx >>= 1;
 }
@@ -190,6 +192,7 @@ void oc_8xy7(void) {
 
 // 8xye: Vx <<= 1 (保留最高位到VF)
 void oc_8xye(void) {
+    if (CHIP8_CPU->quirks & QUIRK_SHIFT_VY) Vx = Vy;
     CHIP8_CPU->registers[0xF] = (Vx & 0x80) ? 1 : 0;
     Vx <<= 1;
 }
@@ -206,14 +209,19 @@ void oc_annn(void) {
     CHIP8_CPU->index = nnn;
 }
 
-// Bxnn: 跳转到V0 + nnn
+// Bxnn: 跳转到V0 + nnn（QUIRK_JUMP_VX时为Vx + xnn）
 void oc_bxnn(void) {
-    CHIP8_CPU->pc = CHIP8_CPU->registers[0] + nnn;
+    if (CHIP8_CPU->quirks & QUIRK_JUMP_VX) {
+        CHIP8_CPU->pc = Vx + nnn;
+    }
+    else {
+        CHIP8_CPU->pc = CHIP8_CPU->registers[0] + nnn;
+    }
 }
 
 // Cxnn: Vx = 随机数 & nn
 void oc_cxnn(void) {
-    Vx = (rand() % 0xFF) & nn;
+    Vx = (cpu_random() % 0xFF) & nn;
 }
 
 // Dxyn: 绘制Sprite (x, y, 高度n)
@@ -299,6 +307,7 @@ void oc_fx29(void) {
 
 // Fx33: 存储Vx的BCD码到内存I/I+1/I+2
 void oc_fx33(void) {
+    DEBUG_WATCH_CHECK(CHIP8_CPU->index, 3);
     CHIP8_CPU->memory[CHIP8_CPU->index] = Vx / 100;          // 百位
     CHIP8_CPU->memory[CHIP8_CPU->index + 1] = (Vx / 10) % 10; // 十位
     CHIP8_CPU->memory[CHIP8_CPU->index + 2] = Vx % 10;        // 个位
@@ -306,10 +315,13 @@ void oc_fx33(void) {
 
 // Fx55: 存储V0-Vx到内存I
 void oc_fx55(void) {
+    DEBUG_WATCH_CHECK(CHIP8_CPU->index, x + 1);
     for (int i = 0; i <= x; i++) {
         CHIP8_CPU->memory[CHIP8_CPU->index + i] = CHIP8_CPU->registers[i];
     }
-    CHIP8_CPU->index += x + 1;
+    if (!(CHIP8_CPU->quirks & QUIRK_LOADSTORE_KEEP_I)) {
+        CHIP8_CPU->index += x + 1;
+    }
 }
 
 // Fx65: 从内存I加载V0-Vx
@@ -317,5 +329,7 @@ void oc_fx65(void) {
     for (int i = 0; i <= x; i++) {
         CHIP8_CPU->registers[i] = CHIP8_CPU->memory[CHIP8_CPU->index + i];
     }
-    CHIP8_CPU->index += x + 1;
+    if (!(CHIP8_CPU->quirks & QUIRK_LOADSTORE_KEEP_I)) {
+        CHIP8_CPU->index += x + 1;
+    }
 }
@@ -4,15 +4,31 @@
 
 #include "chip8_platform.h"
 #include "chip8_cpu.h"
+#include "chip8_capture.h"
+#include "chip8_romlib.h"
+#include "chip8_state.h"
+#include "chip8_input.h"
 
 // 全局SDL资源
 SDL_Window* window = NULL;
 SDL_Renderer* renderer = NULL;
 TTF_Font* font = NULL;
 SDL_AudioDeviceID audio_device;
+static SDL_atomic_t sound_on;     // 蜂鸣开关（主线程每帧按焦点实例发布，音频线程只读此值）
 
-// 键盘映射（CHIP-8 0-F → PC键盘）
-static const int key_map[16] = {
+// 多实例网格状态（grid_count为0表示单实例模式）
+#define GRID_CELL_W (SCREEN_WIDTH + 1)  // 每格右侧/下方留1像素分隔线
+#define GRID_CELL_H (SCREEN_HEIGHT + 1)
+static chip8_cpu_t** grid_tiles = NULL;
+static int grid_count = 0;
+static int grid_cols = 0;
+static int grid_rows = 0;
+static int grid_scale = 1;
+static int grid_focus = 0;
+static SDL_Texture* grid_texture = NULL;  // 所有实例共用的纹理图集
+
+// 键盘映射（CHIP-8 0-F → PC键盘，可按ROM配置替换）
+static const int default_key_map[16] = {
     SDLK_x,    // 0
     SDLK_1,    // 1
     SDLK_2,    // 2
@@ -30,6 +46,7 @@ static const int key_map[16] = {
     SDLK_f,    // E
     SDLK_v     // F
 };
+static int key_map[16];           // 当前键位（display_init时设为默认）
 
 // 音频回调函数（生成方波蜂鸣）
 static void audio_callback(void* userdata, Uint8* stream, int len)
@@ -40,7 +57,7 @@ static void audio_callback(void* userdata, Uint8* stream, int len)
     int sample_rate = 44100;
 
     memset(stream, 0, len);
-    if (CHIP8_CPU->soundTimer == 0) return;
+    if (!SDL_AtomicGet(&sound_on)) return;
 
     // 生成方波
     for (int i = 0; i < len; i += 2) {
@@ -92,6 +109,9 @@ void display_init(void)
         font = TTF_OpenFont(TTF_GetDefaultFont(), 16);
     }
 
+    // 默认键位（加载ROM配置后可能被替换）
+    input_set_keymap(NULL);
+
     // 初始化音频
     audio_init();
 }
@@ -139,6 +159,117 @@ void display_update(void)
     SDL_RenderPresent(renderer);
 }
 
+// 更新网格窗口标题（显示当前键盘焦点）
+static void grid_title(void)
+{
+    char title[128];
+    snprintf(title, sizeof(title), "CHIP-8 Grid (%d tiles) - focus: %d | Tab to switch | +/- adjust speed",
+        grid_count, grid_focus);
+    SDL_SetWindowTitle(window, title);
+}
+
+// 进入网格模式（按实例数自动排布并缩放窗口）
+void grid_init(chip8_cpu_t** tiles, int count)
+{
+    if (!renderer || count <= 0) return;
+    if (count > GRID_MAX_TILES) count = GRID_MAX_TILES;
+
+    grid_tiles = tiles;
+    grid_count = count;
+    grid_cols = 1;
+    while (grid_cols * grid_cols < count) grid_cols++;
+    grid_rows = (count + grid_cols - 1) / grid_cols;
+
+    // 缩放倍数：不超过单实例倍数，且窗口不超过最大尺寸
+    int atlas_w = grid_cols * GRID_CELL_W;
+    int atlas_h = grid_rows * GRID_CELL_H;
+    grid_scale = SCALE;
+    if (grid_scale > GRID_MAX_WIDTH / atlas_w) grid_scale = GRID_MAX_WIDTH / atlas_w;
+    if (grid_scale > GRID_MAX_HEIGHT / atlas_h) grid_scale = GRID_MAX_HEIGHT / atlas_h;
+    if (grid_scale < 1) grid_scale = 1;
+    SDL_SetWindowSize(window, atlas_w * grid_scale, atlas_h * grid_scale);
+
+    grid_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+        SDL_TEXTUREACCESS_STREAMING, atlas_w, atlas_h);
+    if (!grid_texture) {
+        fprintf(stderr, "Grid texture create failed: %s\n", SDL_GetError());
+        exit(EXIT_FAILURE);
+    }
+
+    grid_focus = 0;
+    CHIP8_CPU = grid_tiles[grid_focus];
+    input_set_keymap(CHIP8_CPU->keymap);
+    grid_title();
+}
+
+// 切换键盘焦点到下一个实例（释放原实例的按键）
+static void grid_next_focus(void)
+{
+    memset(grid_tiles[grid_focus]->keypad, 0, sizeof(grid_tiles[grid_focus]->keypad));
+    grid_focus = (grid_focus + 1) % grid_count;
+    CHIP8_CPU = grid_tiles[grid_focus];
+    CHIP8_CPU->draw_flag = 1; // 下一帧重绘焦点红框
+    input_set_keymap(CHIP8_CPU->keymap); // 键位随焦点实例的ROM配置切换
+    grid_title();
+}
+
+// 将所有实例打包进一张纹理并一次绘制（替代逐像素SDL_RenderFillRect）
+void grid_update(void)
+{
+    if (!grid_texture) return;
+
+    void* pixels;
+    int pitch;
+    if (SDL_LockTexture(grid_texture, NULL, &pixels, &pitch) != 0) return;
+
+    // 逐格写入像素（锁定后的纹理内容未定义，需完整覆盖）
+    for (int cell = 0; cell < grid_cols * grid_rows; cell++) {
+        const uint8_t* video = (cell < grid_count) ? grid_tiles[cell]->video : NULL;
+        int ox = (cell % grid_cols) * GRID_CELL_W;
+        int oy = (cell / grid_cols) * GRID_CELL_H;
+
+        for (int y = 0; y < GRID_CELL_H; y++) {
+            Uint32* row = (Uint32*)((Uint8*)pixels + (oy + y) * pitch) + ox;
+            if (y == SCREEN_HEIGHT) {
+                for (int x = 0; x < GRID_CELL_W; x++) row[x] = 0xFF404040; // 分隔线
+                continue;
+            }
+            for (int x = 0; x < SCREEN_WIDTH; x++) {
+                row[x] = (video && video[y * SCREEN_WIDTH + x]) ? 0xFFFFFFFF : 0xFF000000;
+            }
+            row[SCREEN_WIDTH] = 0xFF404040;
+        }
+    }
+    SDL_UnlockTexture(grid_texture);
+
+    // 整张图集一次绘制
+    SDL_Rect dst = { 0, 0, grid_cols * GRID_CELL_W * grid_scale, grid_rows * GRID_CELL_H * grid_scale };
+    SDL_RenderCopy(renderer, grid_texture, NULL, &dst);
+
+    // 焦点实例红框
+    SDL_Rect focus_rect = {
+        (grid_focus % grid_cols) * GRID_CELL_W * grid_scale,
+        (grid_focus / grid_cols) * GRID_CELL_H * grid_scale,
+        SCREEN_WIDTH * grid_scale,
+        SCREEN_HEIGHT * grid_scale
+    };
+    SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
+    SDL_RenderDrawRect(renderer, &focus_rect);
+
+    SDL_RenderPresent(renderer);
+}
+
+// 释放网格纹理
+void grid_destroy(void)
+{
+    if (grid_texture) {
+        SDL_DestroyTexture(grid_texture);
+        grid_texture = NULL;
+    }
+    grid_tiles = NULL;
+    grid_count = 0;
+}
+
 // 释放SDL资源
 void display_destroy(void)
 {
@@ -181,8 +312,10 @@ void input_detect(void)
             char* ext = strrchr(file_path, '.');
             if (ext && strcmp(ext, ".ch8") == 0) {
                 // 重置CPU + 加载新ROM
+                // 已收录的ROM直接从ROM库内存复制，不再读盘
                 reset();
-                if (loadrom(file_path) == 0) {
+                if (romlib_loadrom(file_path, NULL) == 0) {
+                    input_set_keymap(CHIP8_CPU->keymap);
                     printf("Loaded ROM via drag&drop: %s\n", file_path);
                 }
                 else {
@@ -219,17 +352,61 @@ void input_detect(void)
                 is_running = 0;
                 return;
             }
+            // F12键保存PNG截图（后台线程编码）
+            if (event.key.keysym.sym == SDLK_F12) {
+                if (event.type == SDL_KEYDOWN) {
+                    capture_screenshot();
+                }
+                continue;
+            }
+            // F5保存/F9读取快速存档（作用于焦点实例）
+            if (event.key.keysym.sym == SDLK_F5 || event.key.keysym.sym == SDLK_F9) {
+                if (event.type == SDL_KEYDOWN) {
+                    if (event.key.keysym.sym == SDLK_F5) state_quicksave();
+                    else if (state_quickload() == 0) input_set_keymap(CHIP8_CPU->keymap); // 键位随存档中的ROM配置恢复
+                }
+                continue;
+            }
+            // Tab键切换网格模式的键盘焦点
+            if (event.key.keysym.sym == SDLK_TAB) {
+                if (event.type == SDL_KEYDOWN && grid_count > 0) {
+                    grid_next_focus();
+                }
+                continue;
+            }
 
-            // CHIP-8按键映射
+            // CHIP-8按键映射（单实例按事件时间戳排队，帧内对应周期生效；网格模式立即作用于焦点实例）
+            if (event.key.repeat) continue;
             for (int i = 0; i < 16; i++) {
                 if (event.key.keysym.sym == key_map[i]) {
-                    CHIP8_CPU->keypad[i] = (event.type == SDL_KEYDOWN) ? 1 : 0;
+                    uint8_t pressed = (event.type == SDL_KEYDOWN) ? 1 : 0;
+                    if (grid_count > 0) {
+                        CHIP8_CPU->keypad[i] = pressed;
+                    }
+                    else {
+                        input_queue_key(event.key.timestamp, (uint8_t)i, pressed);
+                    }
                 }
             }
         }
     }
 }
 
+// 设置键位（16个按键名字符对应CHIP-8键0-F，NULL或空串恢复默认键位）
+void input_set_keymap(const char* keys)
+{
+    memcpy(key_map, default_key_map, sizeof(key_map));
+    if (!keys || !keys[0]) return;
+
+    for (int i = 0; i < 16 && keys[i]; i++) {
+        char name[2] = { keys[i], '\0' };
+        SDL_Keycode key = SDL_GetKeyFromName(name);
+        if (key != SDLK_UNKNOWN) {
+            key_map[i] = key;
+        }
+    }
+}
+
 // 初始化音频（简化实现）
 void audio_init(void)
 {
@@ -249,6 +426,12 @@ void audio_init(void)
     SDL_PauseAudioDevice(audio_device, 0); // 启动音频播放
 }
 
+// 发布实例的声音状态（音频回调在独立线程运行，不能读取主线程随时切换的CHIP8_CPU）
+void audio_update(const chip8_cpu_t* cpu)
+{
+    SDL_AtomicSet(&sound_on, (cpu && cpu->soundTimer > 0) ? 1 : 0);
+}
+
 // 释放音频资源
 void audio_destroy(void)
 {
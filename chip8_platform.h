@@ -4,6 +4,8 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 
+#include "chip8_cpu.h"
+
 // 显示参数
 #define SCREEN_WIDTH 64
 #define SCREEN_HEIGHT 32
@@ -11,6 +13,11 @@
 #define WINDOW_WIDTH (SCREEN_WIDTH * SCALE)
 #define WINDOW_HEIGHT (SCREEN_HEIGHT * SCALE)
 
+// 多实例网格参数
+#define GRID_MAX_TILES 64         // 最多实例数（8x8）
+#define GRID_MAX_WIDTH 1280       // 网格窗口最大尺寸
+#define GRID_MAX_HEIGHT 720
+
 // 全局SDL资源声明
 extern SDL_Window* window;
 extern SDL_Renderer* renderer;
@@ -21,8 +28,13 @@ void display_init(void);          // 初始化SDL显示/字体
 void display_update(void);        // 更新屏幕显示（含速度百分比）
 void display_destroy(void);       // 释放SDL资源
 void input_detect(void);          // 检测键盘输入（含速度调节）
+void input_set_keymap(const char* keys); // 设置键位（按ROM配置，NULL恢复默认）
 void audio_init(void);            // 初始化音频（简化实现）
+void audio_update(const chip8_cpu_t* cpu); // 每帧发布发声实例的声音定时器状态（网格模式为焦点实例）
 void audio_destroy(void);         // 释放音频资源
 void audio_beep(void);            // 蜂鸣音效（简化实现）
+void grid_init(chip8_cpu_t** tiles, int count); // 进入网格模式（需先display_init，键盘焦点为tiles[0]）
+void grid_update(void);           // 将所有实例打包进一张纹理并一次绘制
+void grid_destroy(void);          // 释放网格纹理
 
 #endif
@@ -0,0 +1,243 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <SDL2/SDL.h>
+
+#include "chip8_cpu.h"
+#include "chip8_regress.h"
+#include "chip8_romlib.h"
+
+// 脚本输入事件
+typedef struct {
+    uint32_t cycle;               // 生效周期
+    uint8_t key;                  // 按键0-F
+    uint8_t pressed;              // 1=按下，0=释放
+} regress_input_t;
+
+// 按生效周期稳定排序（插入排序：同一周期的事件保持清单中的顺序，如同周期先按下后释放）
+static void sort_inputs(regress_input_t* inputs, int count)
+{
+    for (int i = 1; i < count; i++) {
+        regress_input_t ev = inputs[i];
+        int j = i;
+        while (j > 0 && inputs[j - 1].cycle > ev.cycle) {
+            inputs[j] = inputs[j - 1];
+            j--;
+        }
+        inputs[j] = ev;
+    }
+}
+
+// 计算CPU可观测状态哈希（显示缓冲区、寄存器、I、PC、定时器）
+static uint64_t state_hash(void)
+{
+    uint64_t h = FNV1A64_INIT;
+    h = fnv1a64(CHIP8_CPU->video, sizeof(CHIP8_CPU->video), h);
+    h = fnv1a64(CHIP8_CPU->registers, sizeof(CHIP8_CPU->registers), h);
+    h = fnv1a64(&CHIP8_CPU->index, sizeof(CHIP8_CPU->index), h);
+    h = fnv1a64(&CHIP8_CPU->pc, sizeof(CHIP8_CPU->pc), h);
+    h = fnv1a64(&CHIP8_CPU->delayTimer, sizeof(CHIP8_CPU->delayTimer), h);
+    h = fnv1a64(&CHIP8_CPU->soundTimer, sizeof(CHIP8_CPU->soundTimer), h);
+    return h;
+}
+
+// 以ASCII字符画输出显示缓冲区及寄存器（用于快速定位差异）
+static void dump_state(void)
+{
+    printf("  +----------------------------------------------------------------+\n");
+    for (int y = 0; y < 32; y++) {
+        printf("  |");
+        for (int x = 0; x < 64; x++) {
+            putchar(CHIP8_CPU->video[y * 64 + x] ? '#' : '.');
+        }
+        printf("|\n");
+    }
+    printf("  +----------------------------------------------------------------+\n");
+    printf("  PC=%03X I=%03X SP=%X DT=%02X ST=%02X\n  ",
+        CHIP8_CPU->pc, CHIP8_CPU->index, CHIP8_CPU->sp, CHIP8_CPU->delayTimer, CHIP8_CPU->soundTimer);
+    for (int i = 0; i < 16; i++) {
+        printf("V%X=%02X ", i, CHIP8_CPU->registers[i]);
+    }
+    printf("\n");
+}
+
+// 解析按键事件：<键><+|->@<周期>
+static int parse_input(const char* tok, regress_input_t* ev)
+{
+    char key_ch, action;
+    unsigned long cyc;
+    if (sscanf(tok, "%c%c@%lu", &key_ch, &action, &cyc) != 3) return -1;
+    if (action != '+' && action != '-') return -1;
+
+    char key_str[2] = { key_ch, '\0' };
+    char* end;
+    long key = strtol(key_str, &end, 16);
+    if (*end != '\0') return -1;
+
+    ev->key = (uint8_t)key;
+    ev->pressed = (action == '+');
+    ev->cycle = (uint32_t)cyc;
+    return 0;
+}
+
+// 解析黄金哈希：1-16位十六进制（可带0x前缀），含其他字符时返回-1
+static int parse_hash(const char* tok, uint64_t* hash)
+{
+    if (tok[0] == '0' && (tok[1] == 'x' || tok[1] == 'X')) tok += 2;
+    size_t len = strlen(tok);
+    if (len == 0 || len > 16 || strspn(tok, "0123456789abcdefABCDEF") != len) return -1;
+    *hash = strtoull(tok, NULL, 16);
+    return 0;
+}
+
+// 相对路径按清单所在目录解析
+static void resolve_path(const char* manifest_path, const char* rom, char* out, size_t out_size)
+{
+    const char* slash = strrchr(manifest_path, '/');
+    const char* bslash = strrchr(manifest_path, '\\');
+    if (bslash > slash) slash = bslash;
+
+    if (!slash || rom[0] == '/' || rom[0] == '\\' || (rom[0] && rom[1] == ':')) {
+        snprintf(out, out_size, "%s", rom);
+    }
+    else {
+        snprintf(out, out_size, "%.*s%s", (int)(slash - manifest_path + 1), manifest_path, rom);
+    }
+}
+
+// 运行单个ROM并校验，返回0表示通过
+// golden为NULL时只打印当前哈希
+static int regress_one(const char* rom_path, uint32_t cycles, const uint64_t* golden,
+    double min_ips, regress_input_t* inputs, int input_count, const chip8_backend_t* backend)
+{
+    // 每个ROM使用全新CPU实例，并固定随机数种子与速度
+    destroy();
+    init();
+    cpu_seed(REGRESS_SEED);
+    speed_coeff = 1.0f;
+
+    // 经ROM库加载：批量运行时同一ROM只读盘一次，并应用该ROM的兼容性配置
+    if (romlib_loadrom(rom_path, NULL) != 0) {
+        printf("[FAIL] %s: cannot load ROM\n", rom_path);
+        return 1;
+    }
+
+    sort_inputs(inputs, input_count);
+
+    // 无头执行固定周期数（脚本输入在对应周期前生效，两次输入之间整批交给执行后端）
+    int next_input = 0;
+    uint32_t divergences = lockstep_divergences();
+    uint64_t start = SDL_GetPerformanceCounter(); // 墙钟时间（预算针对实际吞吐，不用CPU时间）
+    for (uint32_t c = 0; c < cycles;) {
+        while (next_input < input_count && inputs[next_input].cycle <= c) {
+            CHIP8_CPU->keypad[inputs[next_input].key] = inputs[next_input].pressed;
+            next_input++;
+        }
+        uint32_t end = (next_input < input_count && inputs[next_input].cycle < cycles) ? inputs[next_input].cycle : cycles;
+        if (end - c > INT_MAX) end = c + INT_MAX;
+        backend->run((int)(end - c));
+        c = end;
+    }
+    double elapsed = (double)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+    lockstep_sync(CHIP8_CPU); // 比对最后一个未结束的锁步窗口
+    double ips = (elapsed > 0.0) ? cycles / elapsed : 0.0;
+
+    uint64_t hash = state_hash();
+    int failed = 0;
+
+    // 1. 行为校验：状态哈希与黄金值比对
+    if (!golden) {
+        printf("[HASH] %s: 0x%016" PRIx64 "\n", rom_path, hash);
+    }
+    else if (*golden != hash) {
+        printf("[FAIL] %s: state hash 0x%016" PRIx64 " != golden 0x%016" PRIx64 "\n", rom_path, hash, *golden);
+        dump_state();
+        failed = 1;
+    }
+
+    // 2. 性能校验：指令/秒不得低于预算（elapsed为0说明远快于计时精度，视为通过）
+    if (min_ips > 0.0 && elapsed > 0.0 && ips < min_ips) {
+        printf("[FAIL] %s: %.0f instr/s below budget %.0f instr/s\n", rom_path, ips, min_ips);
+        failed = 1;
+    }
+
+    // 3. 锁步校验：执行后端与参考解释器不得出现分歧
+    if (lockstep_divergences() != divergences) {
+        printf("[FAIL] %s: %u lockstep divergences\n", rom_path, lockstep_divergences() - divergences);
+        failed = 1;
+    }
+
+    if (!failed) {
+        printf("[PASS] %s: %u cycles, %.3f s, %.0f instr/s\n", rom_path, cycles, elapsed, ips);
+    }
+    return failed;
+}
+
+// 无头回归测试入口
+int regress_run(const char* manifest_path, const chip8_backend_t* backend)
+{
+    FILE* manifest = fopen(manifest_path, "r");
+    if (!manifest) {
+        fprintf(stderr, "Failed to open regression manifest: %s\n", manifest_path);
+        return -1;
+    }
+
+    static regress_input_t inputs[REGRESS_MAX_INPUTS];
+    char line[1024];
+    int line_no = 0;
+    int total = 0;
+    int failures = 0;
+
+    while (fgets(line, sizeof(line), manifest)) {
+        line_no++;
+        line[strcspn(line, "\r\n#")] = '\0';
+
+        char* rom = strtok(line, " \t");
+        if (!rom) continue;
+        total++;
+
+        char* cycles_tok = strtok(NULL, " \t");
+        char* golden = strtok(NULL, " \t");
+        char* ips_tok = strtok(NULL, " \t");
+        if (!cycles_tok || !golden || !ips_tok) {
+            fprintf(stderr, "%s:%d: expected <rom> <cycles> <hash|-> <min_ips> [inputs...]\n", manifest_path, line_no);
+            failures++;
+            continue;
+        }
+
+        uint64_t golden_hash = 0;
+        int has_golden = strcmp(golden, "-") != 0;
+        if (has_golden && parse_hash(golden, &golden_hash) != 0) {
+            fprintf(stderr, "%s:%d: bad golden hash '%s'\n", manifest_path, line_no, golden);
+            failures++;
+            continue;
+        }
+
+        int input_count = 0;
+        int bad_input = 0;
+        char* tok;
+        while ((tok = strtok(NULL, " \t")) != NULL) {
+            if (input_count >= REGRESS_MAX_INPUTS || parse_input(tok, &inputs[input_count]) != 0) {
+                fprintf(stderr, "%s:%d: bad input event '%s'\n", manifest_path, line_no, tok);
+                bad_input = 1;
+                break;
+            }
+            input_count++;
+        }
+        if (bad_input) {
+            failures++;
+            continue;
+        }
+
+        char rom_path[512];
+        resolve_path(manifest_path, rom, rom_path, sizeof(rom_path));
+        failures += regress_one(rom_path, (uint32_t)strtoul(cycles_tok, NULL, 0), has_golden ? &golden_hash : NULL,
+            strtod(ips_tok, NULL), inputs, input_count, backend);
+    }
+    fclose(manifest);
+
+    printf("Regression: %d/%d passed\n", total - failures, total);
+    return failures;
+}
@@ -0,0 +1,21 @@
+#ifndef CHIP8_REGRESS_H_
+#define CHIP8_REGRESS_H_
+
+#include "chip8_backend.h"
+
+// 回归测试参数
+#define REGRESS_SEED 0x2C8u        // 固定随机数种子（保证Cxnn结果可重放）
+#define REGRESS_MAX_INPUTS 256     // 每个ROM最多脚本输入事件数
+#define REGRESS_SELFTEST_MANIFEST "regress/manifest.txt" // 随仓库提交的自检清单（--selftest，修改指令实现后运行；
+                                                          // 依次在当前目录、可执行文件目录及其上一级目录下查找）
+
+// 无头回归测试：按清单逐个运行ROM并比对状态哈希与性能预算
+// 清单每行格式（#开头为注释）：
+//   <rom路径> <周期数> <黄金哈希|-> <最低指令/秒|0> [按键事件...]
+// 按键事件格式：<键0-F><+|->@<周期>，如 5+@1200 表示第1200周期按下键5（同一周期按清单顺序生效）
+// 黄金哈希为1-16位十六进制，为"-"时只打印当前哈希（用于生成/更新黄金值）；指令/秒预算按墙钟时间计算
+// backend为执行后端；使用锁步校验时出现分歧的ROM也计为失败
+// 返回失败的ROM数量（清单无法读取时返回-1）
+int regress_run(const char* manifest_path, const chip8_backend_t* backend);
+
+#endif
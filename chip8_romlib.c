@@ -0,0 +1,420 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <inttypes.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#include "chip8_cpu.h"
+#include "chip8_romlib.h"
+#include "chip8_backend.h"
+
+// 已收录ROM（内容唯一，数据位于arena中）
+typedef struct {
+    uint64_t hash;                // 内容哈希（FNV-1a 64）
+    uint32_t offset;              // 在arena中的偏移
+    uint16_t size;                // 字节数
+    int next;                     // 哈希相同但内容不同的下一个ROM（-1表示无，极少出现）
+    const char* name;             // 首次收录时的路径（用于显示）
+} rom_entry_t;
+
+// 路径到ROM的映射（同一内容可对应多个路径）
+typedef struct {
+    char* path;
+    int rom;
+} path_entry_t;
+
+// 配置条目
+typedef struct {
+    uint64_t hash;
+    romlib_profile_t profile;
+} profile_entry_t;
+
+// 开放寻址哈希索引（64位键 → 数组下标）
+typedef struct {
+    uint64_t* keys;
+    int* vals;                    // -1表示空槽
+    uint32_t cap;                 // 2的幂
+    uint32_t count;
+} hash_index_t;
+
+static uint8_t* arena = NULL;     // 所有ROM数据的连续内存区
+static size_t arena_used = 0;
+static size_t arena_cap = 0;
+
+static rom_entry_t* roms = NULL;
+static int rom_count = 0, rom_cap = 0;
+static path_entry_t* paths = NULL;
+static int path_count = 0, path_cap = 0;
+static profile_entry_t* profiles = NULL;
+static int profile_count = 0, profile_cap = 0;
+
+static hash_index_t rom_index;     // 内容哈希 → roms
+static hash_index_t path_index;    // 路径哈希 → paths
+static hash_index_t profile_index; // 内容哈希 → profiles
+
+// 扩容辅助（失败直接退出，与init()的内存分配失败处理一致）
+static void* grow(void* ptr, int* cap, size_t elem)
+{
+    *cap = *cap ? *cap * 2 : 64;
+    void* p = realloc(ptr, (size_t)*cap * elem);
+    if (!p) {
+        fprintf(stderr, "Failed to allocate ROM library memory\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+// 查找键，返回下标（未找到返回-1）
+static int index_find(const hash_index_t* idx, uint64_t key)
+{
+    if (!idx->cap) return -1;
+    for (uint32_t i = (uint32_t)key & (idx->cap - 1);; i = (i + 1) & (idx->cap - 1)) {
+        if (idx->vals[i] < 0) return -1;
+        if (idx->keys[i] == key) return idx->vals[i];
+    }
+}
+
+// 插入/覆盖键（负载超过一半时翻倍重建）
+static void index_put(hash_index_t* idx, uint64_t key, int val)
+{
+    if ((idx->count + 1) * 2 > idx->cap) {
+        hash_index_t bigger = { 0 };
+        bigger.cap = idx->cap ? idx->cap * 2 : 256;
+        bigger.keys = (uint64_t*)malloc(bigger.cap * sizeof(uint64_t));
+        bigger.vals = (int*)malloc(bigger.cap * sizeof(int));
+        if (!bigger.keys || !bigger.vals) {
+            fprintf(stderr, "Failed to allocate ROM library index\n");
+            exit(EXIT_FAILURE);
+        }
+        memset(bigger.vals, 0xFF, bigger.cap * sizeof(int));
+        for (uint32_t i = 0; i < idx->cap; i++) {
+            if (idx->vals[i] >= 0) index_put(&bigger, idx->keys[i], idx->vals[i]);
+        }
+        free(idx->keys);
+        free(idx->vals);
+        *idx = bigger;
+    }
+
+    uint32_t i = (uint32_t)key & (idx->cap - 1);
+    while (idx->vals[i] >= 0 && idx->keys[i] != key) i = (i + 1) & (idx->cap - 1);
+    if (idx->vals[i] < 0) idx->count++;
+    idx->keys[i] = key;
+    idx->vals[i] = val;
+}
+
+// 释放索引
+static void index_free(hash_index_t* idx)
+{
+    free(idx->keys);
+    free(idx->vals);
+    memset(idx, 0, sizeof(*idx));
+}
+
+// 按路径查找ROM（返回roms下标，未收录返回-1）
+static int find_path(const char* path)
+{
+    int p = index_find(&path_index, fnv1a64(path, strlen(path), FNV1A64_INIT));
+    return (p >= 0 && strcmp(paths[p].path, path) == 0) ? paths[p].rom : -1;
+}
+
+// 收录一份ROM数据（相同内容只保存一次），返回roms下标
+static int add_rom(const char* path, const uint8_t* data, size_t size)
+{
+    uint64_t hash = fnv1a64(data, size, FNV1A64_INIT);
+    int first = index_find(&rom_index, hash);
+
+    // 哈希相同时逐字节比较，冲突的不同内容沿链表另存一份
+    int rom = first, last = -1;
+    while (rom >= 0 && (roms[rom].size != size || memcmp(arena + roms[rom].offset, data, size) != 0)) {
+        last = rom;
+        rom = roms[rom].next;
+    }
+
+    if (rom < 0) {
+        // 追加到连续内存区
+        while (arena_used + size > arena_cap) {
+            size_t new_cap = arena_cap ? arena_cap * 2 : 64 * 1024;
+            uint8_t* p = (uint8_t*)realloc(arena, new_cap);
+            if (!p) {
+                fprintf(stderr, "Failed to allocate ROM library memory\n");
+                exit(EXIT_FAILURE);
+            }
+            arena = p;
+            arena_cap = new_cap;
+        }
+        memcpy(arena + arena_used, data, size);
+
+        if (rom_count == rom_cap) roms = (rom_entry_t*)grow(roms, &rom_cap, sizeof(rom_entry_t));
+        rom = rom_count++;
+        roms[rom].hash = hash;
+        roms[rom].offset = (uint32_t)arena_used;
+        roms[rom].size = (uint16_t)size;
+        roms[rom].next = -1;
+        roms[rom].name = NULL;
+        arena_used += size;
+        if (first < 0) index_put(&rom_index, hash, rom);
+        else roms[last].next = rom;
+    }
+
+    // 记录路径映射
+    if (find_path(path) < 0) {
+        if (path_count == path_cap) paths = (path_entry_t*)grow(paths, &path_cap, sizeof(path_entry_t));
+        paths[path_count].path = (char*)malloc(strlen(path) + 1);
+        if (!paths[path_count].path) {
+            fprintf(stderr, "Failed to allocate ROM library memory\n");
+            exit(EXIT_FAILURE);
+        }
+        strcpy(paths[path_count].path, path);
+        paths[path_count].rom = rom;
+        if (!roms[rom].name) roms[rom].name = paths[path_count].path;
+        index_put(&path_index, fnv1a64(path, strlen(path), FNV1A64_INIT), path_count);
+        path_count++;
+    }
+    return rom;
+}
+
+// 读取ROM文件并收录（返回roms下标，失败返回-1）
+static int add_file(const char* path)
+{
+    FILE* rom_file = fopen(path, "rb");
+    if (!rom_file) {
+        fprintf(stderr, "Failed to open ROM file: %s\n", path);
+        return -1;
+    }
+
+    // 多读1字节用于判断是否超出内存限制
+    uint8_t buf[ROMLIB_MAX_ROM_SIZE + 1];
+    size_t size = fread(buf, 1, sizeof(buf), rom_file);
+    fclose(rom_file);
+
+    if (size > ROMLIB_MAX_ROM_SIZE) {
+        fprintf(stderr, "ROM file too large (max size: %d bytes): %s\n", ROMLIB_MAX_ROM_SIZE, path);
+        return -1;
+    }
+    return add_rom(path, buf, size);
+}
+
+// 是否为.ch8文件（不区分大小写）
+static int is_rom_file(const char* name)
+{
+    const char* ext = strrchr(name, '.');
+    return ext && strlen(ext) == 4 &&
+        tolower((unsigned char)ext[1]) == 'c' && tolower((unsigned char)ext[2]) == 'h' && ext[3] == '8';
+}
+
+// 递归扫描目录
+int romlib_scan(const char* dir)
+{
+    int added = 0;
+    char path[1024];
+
+#ifdef _WIN32
+    WIN32_FIND_DATAA fd;
+    snprintf(path, sizeof(path), "%s\\*", dir);
+    HANDLE h = FindFirstFileA(path, &fd);
+    if (h == INVALID_HANDLE_VALUE) {
+        fprintf(stderr, "Failed to scan ROM directory: %s\n", dir);
+        return 0;
+    }
+    do {
+        if (strcmp(fd.cFileName, ".") == 0 || strcmp(fd.cFileName, "..") == 0) continue;
+        if (fd.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) continue; // 跳过符号链接/目录联接（可能成环）
+        snprintf(path, sizeof(path), "%s\\%s", dir, fd.cFileName);
+        if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            added += romlib_scan(path);
+        }
+        else if (is_rom_file(fd.cFileName)) {
+            int before = rom_count;
+            if (add_file(path) >= 0) added += rom_count - before;
+        }
+    } while (FindNextFileA(h, &fd));
+    FindClose(h);
+#else
+    DIR* d = opendir(dir);
+    if (!d) {
+        fprintf(stderr, "Failed to scan ROM directory: %s\n", dir);
+        return 0;
+    }
+    struct dirent* ent;
+    while ((ent = readdir(d)) != NULL) {
+        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0) continue;
+        snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+
+        // lstat不跟随符号链接：跳过链接，避免目录链接成环时无限递归
+        struct stat st;
+        if (lstat(path, &st) != 0 || S_ISLNK(st.st_mode)) continue;
+        if (S_ISDIR(st.st_mode)) {
+            added += romlib_scan(path);
+        }
+        else if (S_ISREG(st.st_mode) && is_rom_file(ent->d_name)) {
+            int before = rom_count;
+            if (add_file(path) >= 0) added += rom_count - before;
+        }
+    }
+    closedir(d);
+#endif
+
+    return added;
+}
+
+// 解析兼容性开关列表（逗号分隔）
+static int parse_quirks(char* list, uint8_t* quirks)
+{
+    for (char* q = strtok(list, ","); q; q = strtok(NULL, ",")) {
+        if (strcmp(q, "shift") == 0) *quirks |= QUIRK_SHIFT_VY;
+        else if (strcmp(q, "loadstore") == 0) *quirks |= QUIRK_LOADSTORE_KEEP_I;
+        else if (strcmp(q, "jump") == 0) *quirks |= QUIRK_JUMP_VX;
+        else return -1;
+    }
+    return 0;
+}
+
+// 加载每ROM配置文件
+int romlib_load_profiles(const char* path)
+{
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "Failed to open ROM profile file: %s\n", path);
+        return -1;
+    }
+
+    char line[512];
+    int line_no = 0, loaded = 0;
+    while (fgets(line, sizeof(line), f)) {
+        line_no++;
+        line[strcspn(line, "\r\n#")] = '\0';
+
+        char* hash_tok = strtok(line, " \t");
+        if (!hash_tok) continue;
+
+        // 先收集选项，避免strtok嵌套
+        char* opts[8];
+        int opt_count = 0;
+        char* tok;
+        while ((tok = strtok(NULL, " \t")) != NULL && opt_count < 8) opts[opt_count++] = tok;
+
+        romlib_profile_t profile;
+        memset(&profile, 0, sizeof(profile));
+        // 哈希必须是完整的16位十六进制（与--romlib-list输出一致），选项超过8个时整行无效
+        int bad = strlen(hash_tok) != 16 || strspn(hash_tok, "0123456789abcdefABCDEF") != 16 || tok != NULL;
+        for (int i = 0; i < opt_count && !bad; i++) {
+            if (strncmp(opts[i], "cycles=", 7) == 0) {
+                profile.cycles = atoi(opts[i] + 7);
+                bad = profile.cycles <= 0;
+            }
+            else if (strncmp(opts[i], "quirks=", 7) == 0) {
+                bad = parse_quirks(opts[i] + 7, &profile.quirks) != 0;
+            }
+            else if (strncmp(opts[i], "keys=", 5) == 0) {
+                bad = strlen(opts[i] + 5) != ROMLIB_KEYMAP_LEN;
+                if (!bad) strcpy(profile.keys, opts[i] + 5);
+            }
+            else {
+                bad = 1;
+            }
+        }
+        if (bad) {
+            fprintf(stderr, "%s:%d: bad profile entry\n", path, line_no);
+            continue;
+        }
+
+        uint64_t hash = strtoull(hash_tok, NULL, 16);
+        int p = index_find(&profile_index, hash);
+        if (p < 0) {
+            if (profile_count == profile_cap) profiles = (profile_entry_t*)grow(profiles, &profile_cap, sizeof(profile_entry_t));
+            p = profile_count++;
+            index_put(&profile_index, hash, p);
+        }
+        profiles[p].hash = hash;
+        profiles[p].profile = profile;
+        loaded++;
+    }
+    fclose(f);
+
+    printf("Loaded %d ROM profiles from %s\n", loaded, path);
+    return loaded;
+}
+
+// 将库中ROM复制到CPU内存并应用配置
+static int load_entry(int rom, const romlib_profile_t** profile)
+{
+    if (!CHIP8_CPU) return -1;
+
+    const rom_entry_t* e = &roms[rom];
+    lockstep_sync(CHIP8_CPU);
+    memcpy(CHIP8_CPU->memory + PROGRAM_START_ADDR, arena + e->offset, e->size);
+    // 清除上一个ROM残留的字节，保证热切换后内存内容只取决于当前ROM
+    memset(CHIP8_CPU->memory + PROGRAM_START_ADDR + e->size, 0, ROMLIB_MAX_ROM_SIZE - e->size);
+
+    int p = index_find(&profile_index, e->hash);
+    const romlib_profile_t* prof = (p >= 0) ? &profiles[p].profile : NULL;
+    // 配置保存在实例内（网格模式下各实例按各自ROM的速度/键位运行）
+    CHIP8_CPU->quirks = prof ? prof->quirks : 0;
+    CHIP8_CPU->cycles_per_frame = (prof && prof->cycles > 0) ? (uint32_t)prof->cycles : BASE_CYCLES_PER_FRAME;
+    memset(CHIP8_CPU->keymap, 0, sizeof(CHIP8_CPU->keymap));
+    if (prof) memcpy(CHIP8_CPU->keymap, prof->keys, sizeof(CHIP8_CPU->keymap));
+    if (profile) *profile = prof;
+    return 0;
+}
+
+// 加载ROM（优先使用库中副本，未收录则读盘并收录）
+int romlib_loadrom(const char* path, const romlib_profile_t** profile)
+{
+    if (profile) *profile = NULL;
+    if (!path || !CHIP8_CPU) return -1;
+
+    int rom = find_path(path);
+    if (rom < 0 && (rom = add_file(path)) < 0) return -1;
+
+    if (load_entry(rom, profile) != 0) return -1;
+    printf("Successfully loaded ROM: %s (size: %u bytes, hash: %016" PRIx64 ")\n",
+        path, roms[rom].size, roms[rom].hash);
+    return 0;
+}
+
+// 按内容哈希加载ROM
+int romlib_load_hash(uint64_t hash, const romlib_profile_t** profile)
+{
+    if (profile) *profile = NULL;
+    int rom = index_find(&rom_index, hash);
+    if (rom < 0) {
+        fprintf(stderr, "ROM %016" PRIx64 " not in library\n", hash);
+        return -1;
+    }
+    return load_entry(rom, profile);
+}
+
+// 列出已收录ROM
+void romlib_list(void)
+{
+    for (int i = 0; i < rom_count; i++) {
+        printf("%016" PRIx64 " %5u  %s\n", roms[i].hash, roms[i].size, roms[i].name);
+    }
+    printf("%d unique ROMs, %d paths, %zu bytes preloaded\n", rom_count, path_count, arena_used);
+}
+
+// 释放ROM库
+void romlib_destroy(void)
+{
+    for (int i = 0; i < path_count; i++) free(paths[i].path);
+    free(paths);
+    free(roms);
+    free(profiles);
+    free(arena);
+    paths = NULL;
+    roms = NULL;
+    profiles = NULL;
+    arena = NULL;
+    path_count = path_cap = rom_count = rom_cap = profile_count = profile_cap = 0;
+    arena_used = arena_cap = 0;
+    index_free(&rom_index);
+    index_free(&path_index);
+    index_free(&profile_index);
+}
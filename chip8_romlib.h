@@ -0,0 +1,28 @@
+#ifndef CHIP8_ROMLIB_H_
+#define CHIP8_ROMLIB_H_
+
+#include <stdint.h>
+
+// ROM库参数
+#define ROMLIB_MAX_ROM_SIZE (4096 - 0x200) // 单个ROM最大字节数
+#define ROMLIB_KEYMAP_LEN 16
+
+// 每ROM配置（按内容哈希关联）
+// 配置文件每行格式（#开头为注释）：
+//   <内容哈希16位十六进制> [cycles=N] [quirks=shift,loadstore,jump] [keys=16个按键名字符]
+// 例：9d3a6c1f00b2e471 cycles=15 quirks=shift keys=x123qwerasdzc4fv
+typedef struct {
+    int cycles;                               // 每帧周期数（0表示默认）
+    uint8_t quirks;                           // 兼容性开关（QUIRK_*）
+    char keys[ROMLIB_KEYMAP_LEN + 1];         // CHIP-8键0-F对应的按键字符（空串表示默认键位）
+} romlib_profile_t;
+
+// ROM库函数声明
+int romlib_scan(const char* dir);             // 递归扫描目录中的.ch8并预加载到连续内存区（不跟随符号链接，返回新增数量）
+int romlib_load_profiles(const char* path);   // 加载每ROM配置文件（返回条目数，失败返回-1）
+int romlib_loadrom(const char* path, const romlib_profile_t** profile); // 加载ROM到CHIP8_CPU（优先使用库中副本，未收录则读盘并收录；配置写入实例）
+int romlib_load_hash(uint64_t hash, const romlib_profile_t** profile);  // 按内容哈希加载ROM
+void romlib_list(void);                       // 列出已收录ROM（哈希/大小/路径）
+void romlib_destroy(void);                    // 释放ROM库
+
+#endif
@@ -0,0 +1,154 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include "chip8_cpu.h"
+#include "chip8_slab.h"
+
+// 内存块
+typedef struct {
+    uint8_t* base;
+    size_t used;                  // 已切分的实例数
+    slab_pages_t pages;
+} slab_chunk_t;
+
+// 空闲实例链表节点（复用实例自身的内存）
+typedef struct slab_free_node {
+    struct slab_free_node* next;
+} slab_free_node_t;
+
+static slab_chunk_t* chunks = NULL;
+static int chunk_count = 0;
+static int chunk_capacity = 0;
+static slab_free_node_t* free_list = NULL;
+static size_t live = 0;           // 已分配未归还的实例数
+
+// 申请一个SLAB_CHUNK_SIZE对齐的内存块：优先预留大页，其次透明大页，最后普通页
+static uint8_t* chunk_map(slab_pages_t* pages)
+{
+#ifdef _WIN32
+    // 大页需要SeLockMemoryPrivilege权限，这里只使用普通页
+    *pages = SLAB_PAGES_NORMAL;
+    return (uint8_t*)VirtualAlloc(NULL, SLAB_CHUNK_SIZE, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+#ifdef MAP_HUGETLB
+    void* p = mmap(NULL, SLAB_CHUNK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p != MAP_FAILED) {
+        *pages = SLAB_PAGES_HUGETLB;
+        return (uint8_t*)p;
+    }
+#endif
+
+    // 多映射一块再裁掉首尾，得到2MB对齐的区域（透明大页要求对齐）
+    uint8_t* raw = (uint8_t*)mmap(NULL, SLAB_CHUNK_SIZE * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return NULL;
+    uint8_t* base = (uint8_t*)(((uintptr_t)raw + SLAB_CHUNK_SIZE - 1) & ~(uintptr_t)(SLAB_CHUNK_SIZE - 1));
+    if (base > raw) munmap(raw, base - raw);
+    if (raw + SLAB_CHUNK_SIZE * 2 > base + SLAB_CHUNK_SIZE) {
+        munmap(base + SLAB_CHUNK_SIZE, (raw + SLAB_CHUNK_SIZE * 2) - (base + SLAB_CHUNK_SIZE));
+    }
+
+    *pages = SLAB_PAGES_NORMAL;
+#ifdef MADV_HUGEPAGE
+    if (madvise(base, SLAB_CHUNK_SIZE, MADV_HUGEPAGE) == 0) {
+        *pages = SLAB_PAGES_TRANSPARENT;
+    }
+#endif
+    return base;
+#endif
+}
+
+// 释放内存块
+static void chunk_unmap(uint8_t* base)
+{
+#ifdef _WIN32
+    VirtualFree(base, 0, MEM_RELEASE);
+#else
+    munmap(base, SLAB_CHUNK_SIZE);
+#endif
+}
+
+// 分配一个清零的实例
+chip8_cpu_t* slab_alloc(void)
+{
+    // 1. 优先复用空闲实例
+    if (free_list) {
+        chip8_cpu_t* cpu = (chip8_cpu_t*)free_list;
+        free_list = free_list->next;
+        memset(cpu, 0, sizeof(chip8_cpu_t));
+        live++;
+        return cpu;
+    }
+
+    // 2. 当前块已切完时申请新块（新映射的内存已清零）
+    if (chunk_count == 0 || chunks[chunk_count - 1].used == SLAB_PER_CHUNK) {
+        if (chunk_count == chunk_capacity) {
+            chunk_capacity = chunk_capacity ? chunk_capacity * 2 : 8;
+            chunks = (slab_chunk_t*)realloc(chunks, chunk_capacity * sizeof(slab_chunk_t));
+            if (!chunks) {
+                fprintf(stderr, "Failed to allocate slab table\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        slab_chunk_t* chunk = &chunks[chunk_count];
+        chunk->base = chunk_map(&chunk->pages);
+        if (!chunk->base) return NULL;
+        chunk->used = 0;
+        chunk_count++;
+    }
+
+    slab_chunk_t* chunk = &chunks[chunk_count - 1];
+    chip8_cpu_t* cpu = (chip8_cpu_t*)(chunk->base + chunk->used * sizeof(chip8_cpu_t));
+    chunk->used++;
+    live++;
+    return cpu;
+}
+
+// 归还实例（全部归还后释放所有块）
+int slab_free(chip8_cpu_t* cpu)
+{
+    int owned = 0;
+    for (int i = 0; i < chunk_count && !owned; i++) {
+        owned = (uint8_t*)cpu >= chunks[i].base && (uint8_t*)cpu < chunks[i].base + SLAB_CHUNK_SIZE;
+    }
+    if (!owned) return 0;
+
+    slab_free_node_t* node = (slab_free_node_t*)cpu;
+    node->next = free_list;
+    free_list = node;
+
+    if (--live == 0) {
+        for (int i = 0; i < chunk_count; i++) {
+            chunk_unmap(chunks[i].base);
+        }
+        free(chunks);
+        chunks = NULL;
+        chunk_count = 0;
+        chunk_capacity = 0;
+        free_list = NULL;
+    }
+    return 1;
+}
+
+// 打印分配器状态
+void slab_report(void)
+{
+    static const char* const page_names[] = { "4KB pages", "transparent huge pages", "hugetlb pages" };
+    int counts[3] = { 0, 0, 0 };
+    for (int i = 0; i < chunk_count; i++) {
+        counts[chunks[i].pages]++;
+    }
+    printf("Slab: %zu live instances (%zu bytes each, %zu per chunk) in %d chunks:",
+        live, sizeof(chip8_cpu_t), (size_t)SLAB_PER_CHUNK, chunk_count);
+    for (int i = 0; i < 3; i++) {
+        if (counts[i]) printf(" %d %s", counts[i], page_names[i]);
+    }
+    printf("\n");
+}
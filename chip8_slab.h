@@ -0,0 +1,25 @@
+#ifndef CHIP8_SLAB_H_
+#define CHIP8_SLAB_H_
+
+#include <stddef.h>
+
+#include "chip8_cpu.h"
+
+// 实例分配器参数
+#define SLAB_CHUNK_SIZE (2u * 1024 * 1024) // 每块2MB（一个x86-64大页）
+#define SLAB_PER_CHUNK (SLAB_CHUNK_SIZE / sizeof(chip8_cpu_t))
+
+// 大页类型
+typedef enum {
+    SLAB_PAGES_NORMAL = 0,        // 普通4KB页
+    SLAB_PAGES_TRANSPARENT,       // 透明大页（madvise建议，由内核决定是否合并）
+    SLAB_PAGES_HUGETLB            // 预留大页（MAP_HUGETLB）
+} slab_pages_t;
+
+// CPU实例分配器：从大页支撑的内存块中按定长切分实例，空闲实例串成链表复用
+// 实例按缓存行对齐且连续排列，轮流执行大量实例时TLB与缓存命中更好
+chip8_cpu_t* slab_alloc(void);    // 分配一个清零的实例（内存不足时返回NULL）
+int slab_free(chip8_cpu_t* cpu);  // 归还实例（cpu不属于分配器时返回0）
+void slab_report(void);           // 打印块数/实例数/大页类型
+
+#endif
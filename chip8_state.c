@@ -0,0 +1,228 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "chip8_cpu.h"
+#include "chip8_state.h"
+#include "chip8_backend.h"
+
+// 头部必须正好STATE_HEADER_SIZE字节（编译期检查）
+typedef char state_header_size_check[(sizeof(state_header_t) == STATE_HEADER_SIZE) ? 1 : -1];
+
+// 映射实例登记（cpu_free据此区分映射内存与calloc内存）
+typedef struct {
+    chip8_cpu_t* cpu;
+    void* base;                   // 映射起始地址（头部）
+    size_t size;
+} state_mapping_t;
+
+static state_mapping_t* mappings = NULL;
+static int mapping_count = 0;
+static int mapping_capacity = 0;
+
+static char quick_path[512] = STATE_DEFAULT_PATH;
+
+// 保存实例：头部与状态区拼成一块，一次写入临时文件后改名（避免写一半的存档覆盖旧存档）
+int state_save(const char* path, const chip8_cpu_t* cpu, int checksum)
+{
+    static uint8_t buffer[STATE_HEADER_SIZE + sizeof(chip8_cpu_t)];
+    state_header_t* header = (state_header_t*)buffer;
+
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, "C8ST", 4);
+    header->version = STATE_VERSION;
+    header->header_size = STATE_HEADER_SIZE;
+    header->state_size = sizeof(chip8_cpu_t);
+    if (checksum) {
+        header->flags |= STATE_FLAG_CHECKSUM;
+        header->checksum = fnv1a64(cpu, sizeof(chip8_cpu_t), FNV1A64_INIT);
+    }
+    memcpy(buffer + STATE_HEADER_SIZE, cpu, sizeof(chip8_cpu_t));
+
+    char tmp_path[520];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    FILE* f = fopen(tmp_path, "wb");
+    if (!f) {
+        fprintf(stderr, "Failed to open save state: %s\n", tmp_path);
+        return -1;
+    }
+    size_t written = fwrite(buffer, 1, sizeof(buffer), f);
+    if (fclose(f) != 0 || written != sizeof(buffer)) {
+        fprintf(stderr, "Failed to write save state: %s\n", tmp_path);
+        remove(tmp_path);
+        return -1;
+    }
+
+#ifdef _WIN32
+    remove(path); // Windows下rename不覆盖已有文件
+#endif
+    if (rename(tmp_path, path) != 0) {
+        fprintf(stderr, "Failed to replace save state: %s\n", path);
+        remove(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+// 校验存档头部与状态区
+static int state_check(const char* path, const void* data, size_t size)
+{
+    const state_header_t* header = (const state_header_t*)data;
+    if (size != STATE_HEADER_SIZE + sizeof(chip8_cpu_t) || memcmp(header->magic, "C8ST", 4) != 0 ||
+        header->version != STATE_VERSION || header->header_size != STATE_HEADER_SIZE ||
+        header->state_size != sizeof(chip8_cpu_t)) {
+        fprintf(stderr, "Not a version %d save state for this build: %s\n", STATE_VERSION, path);
+        return -1;
+    }
+    if ((header->flags & STATE_FLAG_CHECKSUM) &&
+        fnv1a64((const uint8_t*)data + STATE_HEADER_SIZE, sizeof(chip8_cpu_t), FNV1A64_INIT) != header->checksum) {
+        fprintf(stderr, "Save state checksum mismatch: %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+// 释放映射（或Windows下的读入缓冲区）
+static void release(void* base, size_t size)
+{
+#ifdef _WIN32
+    (void)size;
+    _aligned_free(base);
+#else
+    munmap(base, size);
+#endif
+}
+
+// 映射存档文件（MAP_PRIVATE：只读共享，写入时按页复制，不回写文件）
+// Windows下退化为读入按缓存行对齐的堆内存（头部64字节，状态区保持chip8_cpu_t的对齐要求）
+static void* map_file(const char* path, size_t* size)
+{
+#ifdef _WIN32
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    void* base = (len > 0) ? _aligned_malloc((size_t)len, CHIP8_CACHELINE) : NULL;
+    if (!base || fread(base, 1, (size_t)len, f) != (size_t)len) {
+        if (base) _aligned_free(base);
+        fclose(f);
+        return NULL;
+    }
+    fclose(f);
+    *size = (size_t)len;
+    return base;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+    void* base = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd); // 映射建立后即可关闭文件描述符
+    if (base == MAP_FAILED) return NULL;
+    *size = (size_t)st.st_size;
+    return base;
+#endif
+}
+
+// 将存档映射为新实例
+chip8_cpu_t* state_map(const char* path)
+{
+    size_t size = 0;
+    void* base = map_file(path, &size);
+    if (!base) {
+        fprintf(stderr, "Failed to open save state: %s\n", path);
+        return NULL;
+    }
+    if (state_check(path, base, size) != 0) {
+        release(base, size);
+        return NULL;
+    }
+
+    if (mapping_count == mapping_capacity) {
+        mapping_capacity = mapping_capacity ? mapping_capacity * 2 : 16;
+        mappings = (state_mapping_t*)realloc(mappings, mapping_capacity * sizeof(state_mapping_t));
+        if (!mappings) {
+            fprintf(stderr, "Failed to allocate save state table\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    chip8_cpu_t* cpu = (chip8_cpu_t*)((uint8_t*)base + STATE_HEADER_SIZE);
+    mappings[mapping_count].cpu = cpu;
+    mappings[mapping_count].base = base;
+    mappings[mapping_count].size = size;
+    mapping_count++;
+    return cpu;
+}
+
+// 将存档复制到CHIP8_CPU（用于运行中读档，网格等持有实例指针的场景不受影响）
+int state_load(const char* path)
+{
+    size_t size = 0;
+    void* base = map_file(path, &size);
+    if (!base) {
+        fprintf(stderr, "Failed to open save state: %s\n", path);
+        return -1;
+    }
+    int result = state_check(path, base, size);
+    if (result == 0) {
+        lockstep_sync(CHIP8_CPU);
+        memcpy(CHIP8_CPU, (uint8_t*)base + STATE_HEADER_SIZE, sizeof(chip8_cpu_t));
+    }
+    release(base, size);
+    return result;
+}
+
+// 释放映射实例
+int state_unmap(chip8_cpu_t* cpu)
+{
+    for (int i = 0; i < mapping_count; i++) {
+        if (mappings[i].cpu == cpu) {
+            release(mappings[i].base, mappings[i].size);
+            mappings[i] = mappings[--mapping_count];
+            if (mapping_count == 0) {
+                free(mappings);
+                mappings = NULL;
+                mapping_capacity = 0;
+            }
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 设置快速存档路径
+void state_set_path(const char* path)
+{
+    snprintf(quick_path, sizeof(quick_path), "%s", path);
+}
+
+// F5：保存当前实例（带校验）
+void state_quicksave(void)
+{
+    if (CHIP8_CPU && state_save(quick_path, CHIP8_CPU, 1) == 0) {
+        printf("State saved: %s\n", quick_path);
+    }
+}
+
+// F9：读取快速存档
+int state_quickload(void)
+{
+    if (!CHIP8_CPU || state_load(quick_path) != 0) return -1;
+    CHIP8_CPU->draw_flag = 1;
+    printf("State loaded: %s\n", quick_path);
+    return 0;
+}
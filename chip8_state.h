@@ -0,0 +1,37 @@
+#ifndef CHIP8_STATE_H_
+#define CHIP8_STATE_H_
+
+#include <stdint.h>
+
+#include "chip8_cpu.h"
+
+// 存档参数
+#define STATE_VERSION 3                    // chip8_cpu_t布局变化时递增（2：冷热分块布局，3：实例内ROM配置）
+#define STATE_HEADER_SIZE 64               // 头部定长64字节，状态区紧随其后（映射后保持对齐）
+#define STATE_FLAG_CHECKSUM 0x01           // 状态区带FNV-1a 64校验
+#define STATE_DEFAULT_PATH "quicksave.c8s" // F5/F9默认存档路径
+
+// 存档文件头（按主机字节序写盘）
+// 文件格式：头部 + 原样的chip8_cpu_t（含定时器计数、随机数状态与ROM配置），无需解析即可直接映射使用
+typedef struct {
+    char magic[4];                // "C8ST"
+    uint16_t version;             // STATE_VERSION
+    uint16_t header_size;         // STATE_HEADER_SIZE
+    uint32_t state_size;          // sizeof(chip8_cpu_t)（编译器/平台填充不同时拒绝加载）
+    uint32_t flags;               // STATE_FLAG_*
+    uint64_t checksum;            // 状态区校验值（无STATE_FLAG_CHECKSUM时为0）
+    uint8_t reserved[40];
+} state_header_t;
+
+// 存档函数声明
+int state_save(const char* path, const chip8_cpu_t* cpu, int checksum); // 保存实例（一次写入，失败返回-1）
+chip8_cpu_t* state_map(const char* path);  // 将存档映射为新实例（写时复制，多个实例共享同一基准存档的未修改页）
+int state_load(const char* path);          // 将存档复制到CHIP8_CPU（实例指针不变，失败返回-1）
+int state_unmap(chip8_cpu_t* cpu);         // 释放映射实例（cpu不是映射实例时返回0）
+
+// 快速存档（F5保存/F9读取）
+void state_set_path(const char* path);     // 设置快速存档路径（默认STATE_DEFAULT_PATH）
+void state_quicksave(void);
+int state_quickload(void);        // 成功返回0
+
+#endif
@@ -0,0 +1,276 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "chip8_cpu.h"
+#include "chip8_stream.h"
+
+#ifdef _WIN32
+
+// Windows暂不支持Unix域socket推流
+int stream_open(const char* socket_path)
+{
+    fprintf(stderr, "Frame streaming is not supported on this platform: %s\n", socket_path);
+    return -1;
+}
+void stream_frame(void) {}
+void stream_poll_input(void) {}
+void stream_close(void) {}
+
+#else
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0               // 无此标志的平台依赖忽略SIGPIPE
+#endif
+
+// 观看端连接
+typedef struct {
+    int fd;                          // -1表示空闲
+    int need_key;                    // 下一帧必须发送关键帧（新连接或丢过帧）
+    int pending;                     // 未配对的按键字节（-1表示无）
+} stream_client_t;
+
+static int listen_fd = -1;
+static char listen_path[sizeof(((struct sockaddr_un*)0)->sun_path)];
+static stream_client_t clients[STREAM_MAX_CLIENTS];
+static uint8_t prev_frame[STREAM_FRAME_BYTES];   // 上一次发布的打包帧
+static uint32_t frame_seq = 0;
+
+// 设置非阻塞
+static int set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    return (flags < 0) ? -1 : fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+// 在Unix域socket上监听
+int stream_open(const char* socket_path)
+{
+    struct sockaddr_un addr;
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Stream socket path too long: %s\n", socket_path);
+        return -1;
+    }
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        fprintf(stderr, "Stream socket create failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, socket_path);
+    unlink(socket_path); // 删除上次异常退出残留的socket文件
+
+    if (bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        listen(listen_fd, STREAM_MAX_CLIENTS) < 0 ||
+        set_nonblocking(listen_fd) < 0) {
+        fprintf(stderr, "Stream socket listen failed on %s: %s\n", socket_path, strerror(errno));
+        close(listen_fd);
+        listen_fd = -1;
+        return -1;
+    }
+
+    strcpy(listen_path, socket_path);
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        clients[i].fd = -1;
+    }
+    signal(SIGPIPE, SIG_IGN); // 观看端断开时send返回错误而不是终止进程
+
+    printf("Streaming frames on %s\n", socket_path);
+    return 0;
+}
+
+// 断开观看端
+static void client_drop(stream_client_t* c)
+{
+    close(c->fd);
+    c->fd = -1;
+}
+
+// 打包显示缓冲区为1位/像素（高位在左）
+static void pack_frame(uint8_t* out)
+{
+    const uint8_t* v = CHIP8_CPU->video;
+    for (int i = 0; i < STREAM_FRAME_BYTES; i++, v += 8) {
+        out[i] = (uint8_t)((v[0] << 7) | (v[1] << 6) | (v[2] << 5) | (v[3] << 4) |
+            (v[4] << 3) | (v[5] << 2) | (v[6] << 1) | v[7]);
+    }
+}
+
+// 游程编码：输出 (count, byte) 对，返回编码后长度（最坏512字节）
+static int rle_encode(const uint8_t* in, uint8_t* out)
+{
+    int len = 0;
+    for (int i = 0; i < STREAM_FRAME_BYTES;) {
+        uint8_t b = in[i];
+        int run = 1;
+        while (i + run < STREAM_FRAME_BYTES && run < 255 && in[i + run] == b) run++;
+        out[len++] = (uint8_t)run;
+        out[len++] = b;
+        i += run;
+    }
+    return len;
+}
+
+// 填写包头
+static void write_header(uint8_t* pkt, uint8_t type, int payload_len)
+{
+    pkt[0] = 'C';
+    pkt[1] = '8';
+    pkt[2] = 'F';
+    pkt[3] = type;
+    pkt[4] = (uint8_t)(frame_seq);
+    pkt[5] = (uint8_t)(frame_seq >> 8);
+    pkt[6] = (uint8_t)(frame_seq >> 16);
+    pkt[7] = (uint8_t)(frame_seq >> 24);
+    pkt[8] = (uint8_t)(payload_len);
+    pkt[9] = (uint8_t)(payload_len >> 8);
+    pkt[10] = 0;
+    pkt[11] = 0;
+}
+
+// 发送整包；缓冲区满时本帧丢弃并要求下次发关键帧，写入不完整则断开
+static void client_send(stream_client_t* c, const uint8_t* pkt, int len)
+{
+    ssize_t sent = send(c->fd, pkt, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (sent == len) {
+        c->need_key = 0;
+    }
+    else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        c->need_key = 1;
+    }
+    else {
+        client_drop(c);
+    }
+}
+
+// 发布当前显示缓冲区
+void stream_frame(void)
+{
+    if (listen_fd < 0) return;
+
+    int any_client = 0, any_key = 0;
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        if (clients[i].fd >= 0) {
+            any_client = 1;
+            any_key |= clients[i].need_key;
+        }
+    }
+    if (!any_client) return;
+
+    uint8_t cur[STREAM_FRAME_BYTES];
+    uint8_t delta[STREAM_FRAME_BYTES];
+    uint8_t key_pkt[STREAM_HEADER_BYTES + STREAM_FRAME_BYTES * 2];
+    uint8_t delta_pkt[STREAM_HEADER_BYTES + STREAM_FRAME_BYTES * 2];
+    int key_len = 0;
+
+    pack_frame(cur);
+    frame_seq++;
+
+    // 周期性关键帧：所有观看端都重新同步
+    int periodic = (frame_seq % STREAM_KEYFRAME_INTERVAL) == 0;
+    if (periodic || any_key) {
+        key_len = STREAM_HEADER_BYTES + rle_encode(cur, key_pkt + STREAM_HEADER_BYTES);
+        write_header(key_pkt, 'K', key_len - STREAM_HEADER_BYTES);
+    }
+
+    int delta_len = 0;
+    if (!periodic) {
+        for (int i = 0; i < STREAM_FRAME_BYTES; i++) {
+            delta[i] = cur[i] ^ prev_frame[i];
+        }
+        delta_len = STREAM_HEADER_BYTES + rle_encode(delta, delta_pkt + STREAM_HEADER_BYTES);
+        write_header(delta_pkt, 'D', delta_len - STREAM_HEADER_BYTES);
+    }
+
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        stream_client_t* c = &clients[i];
+        if (c->fd < 0) continue;
+        if (periodic || c->need_key) {
+            client_send(c, key_pkt, key_len);
+        }
+        else {
+            client_send(c, delta_pkt, delta_len);
+        }
+    }
+
+    memcpy(prev_frame, cur, sizeof(prev_frame));
+}
+
+// 接收新连接与观看端按键事件
+void stream_poll_input(void)
+{
+    if (listen_fd < 0) return;
+
+    // 1. 接受新连接（新观看端先收关键帧）
+    int fd;
+    while ((fd = accept(listen_fd, NULL, NULL)) >= 0) {
+        int slot = -1;
+        for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+            if (clients[i].fd < 0) {
+                slot = i;
+                break;
+            }
+        }
+        if (slot < 0 || set_nonblocking(fd) < 0) {
+            close(fd);
+            continue;
+        }
+        clients[slot].fd = fd;
+        clients[slot].need_key = 1;
+        clients[slot].pending = -1;
+        CHIP8_CPU->draw_flag = 1; // 触发一次发布，让新观看端立即看到画面
+    }
+
+    // 2. 读取按键事件（每事件2字节）
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        stream_client_t* c = &clients[i];
+        if (c->fd < 0) continue;
+
+        uint8_t buf[64];
+        ssize_t len;
+        while ((len = recv(c->fd, buf, sizeof(buf), 0)) > 0) {
+            for (ssize_t j = 0; j < len; j++) {
+                if (c->pending < 0) {
+                    c->pending = buf[j];  // 事件可能被拆在两次recv之间
+                    continue;
+                }
+                if (c->pending < 16) {
+                    CHIP8_CPU->keypad[c->pending] = buf[j] ? 1 : 0;
+                }
+                else if (c->pending == STREAM_KEY_REQUEST) {
+                    c->need_key = 1;
+                    CHIP8_CPU->draw_flag = 1;
+                }
+                c->pending = -1;
+            }
+        }
+        if (len == 0 || (len < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+            client_drop(c); // 观看端关闭连接
+        }
+    }
+}
+
+// 关闭socket并删除socket文件
+void stream_close(void)
+{
+    if (listen_fd < 0) return;
+
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        if (clients[i].fd >= 0) client_drop(&clients[i]);
+    }
+    close(listen_fd);
+    listen_fd = -1;
+    unlink(listen_path);
+}
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef CHIP8_STREAM_H_
+#define CHIP8_STREAM_H_
+
+#include <stdint.h>
+
+// 推流参数
+#define STREAM_MAX_CLIENTS 8            // 每个实例最多同时连接的观看端
+#define STREAM_KEYFRAME_INTERVAL 120    // 每隔多少帧强制发送关键帧
+#define STREAM_FRAME_BYTES (64 * 32 / 8) // 1位/像素打包后的帧大小（256字节）
+
+// 帧包格式（服务端→观看端，小端）：
+//   uint8  magic[3] = "C8F"
+//   uint8  type     = 'K'（关键帧）| 'D'（与上一帧的异或差分）
+//   uint32 seq      帧序号
+//   uint16 len      负载字节数
+//   uint16 reserved
+//   负载：对256字节打包帧（关键帧）或异或差分（差分帧）做游程编码，
+//         由若干 (count 1-255, byte) 对组成，解码后总长256字节。
+//         打包顺序为逐行、每字节8像素、高位在左。
+// 按键包格式（观看端→服务端）：
+//   uint8 key（0-F；0xFF表示请求关键帧）, uint8 state（1=按下，0=释放）
+#define STREAM_HEADER_BYTES 12
+#define STREAM_KEY_REQUEST 0xFF
+
+// 推流函数声明
+int stream_open(const char* socket_path); // 在Unix域socket上监听（失败返回-1）
+void stream_frame(void);                  // 发布当前显示缓冲区（draw_flag置位时调用）
+void stream_poll_input(void);             // 接收新连接与观看端按键事件
+void stream_close(void);                  // 关闭socket并删除socket文件
+
+#endif
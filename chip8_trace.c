@@ -0,0 +1,227 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <SDL2/SDL.h>
+
+#include "chip8_cpu.h"
+#include "chip8_trace.h"
+
+// 全局变量定义
+int trace_active = 0;
+
+// 单生产者（执行循环）/单消费者（落盘线程）无锁环形缓冲区
+// head只由生产者写，tail只由消费者写，均只增不减（按2^32回绕）
+static trace_record_t ring[TRACE_RING_SIZE];
+static SDL_atomic_t ring_head;
+static SDL_atomic_t ring_tail;
+static uint32_t local_head = 0;   // 生产者本地head（避免每条指令原子读）
+static uint32_t cached_tail = 0;  // 生产者缓存的tail（仅在看似已满时刷新）
+static uint32_t trace_cycle = 0;
+static uint32_t producer_waits = 0;
+
+static FILE* trace_file = NULL;
+static SDL_Thread* flush_thread = NULL;
+static SDL_atomic_t flush_stop;
+
+// 落盘线程：批量写出head与tail之间的连续记录，空闲时短暂休眠
+static int flush_main(void* arg)
+{
+    (void)arg;
+    uint32_t tail = (uint32_t)SDL_AtomicGet(&ring_tail);
+    for (;;) {
+        int stopping = SDL_AtomicGet(&flush_stop);
+        uint32_t head = (uint32_t)SDL_AtomicGet(&ring_head);
+        SDL_MemoryBarrierAcquire();
+
+        if (head == tail) {
+            if (stopping) break;
+            SDL_Delay(1);
+            continue;
+        }
+
+        // 写到环形缓冲区末尾或head为止
+        uint32_t start = tail & (TRACE_RING_SIZE - 1);
+        uint32_t count = head - tail;
+        if (count > TRACE_RING_SIZE - start) count = TRACE_RING_SIZE - start;
+        fwrite(&ring[start], sizeof(trace_record_t), count, trace_file);
+
+        tail += count;
+        SDL_MemoryBarrierRelease();
+        SDL_AtomicSet(&ring_tail, (int)tail);
+    }
+    return 0;
+}
+
+// 开始追踪
+int trace_open(const char* path)
+{
+    trace_file = fopen(path, "wb");
+    if (!trace_file) {
+        fprintf(stderr, "Failed to open trace file: %s\n", path);
+        return -1;
+    }
+
+    const uint16_t header[2] = { TRACE_VERSION, sizeof(trace_record_t) };
+    fwrite("C8TR", 1, 4, trace_file);
+    fwrite(header, sizeof(uint16_t), 2, trace_file);
+
+    SDL_AtomicSet(&ring_head, 0);
+    SDL_AtomicSet(&ring_tail, 0);
+    SDL_AtomicSet(&flush_stop, 0);
+    local_head = 0;
+    cached_tail = 0;
+    trace_cycle = 0;
+    producer_waits = 0;
+
+    flush_thread = SDL_CreateThread(flush_main, "chip8_trace", NULL);
+    if (!flush_thread) {
+        fprintf(stderr, "Trace thread create failed: %s\n", SDL_GetError());
+        fclose(trace_file);
+        trace_file = NULL;
+        return -1;
+    }
+
+    trace_active = 1;
+    printf("Tracing instructions to %s\n", path);
+    return 0;
+}
+
+// 追踪运行循环（替代main中的cycle()循环，cycle()本身不含追踪代码）
+void trace_run(int cycles)
+{
+    for (int i = 0; i < cycles; i++) {
+        uint8_t before[16];
+        uint16_t pc = CHIP8_CPU->pc;
+        memcpy(before, CHIP8_CPU->registers, sizeof(before));
+
+        cycle();
+
+        // 缓冲区满时先发布已写记录，再等待落盘线程（保证记录完整，不丢条目）
+        if (local_head - cached_tail >= TRACE_RING_SIZE) {
+            SDL_MemoryBarrierRelease();
+            SDL_AtomicSet(&ring_head, (int)local_head);
+            while (local_head - (cached_tail = (uint32_t)SDL_AtomicGet(&ring_tail)) >= TRACE_RING_SIZE) {
+                producer_waits++;
+                SDL_Delay(0);
+            }
+            SDL_MemoryBarrierAcquire();
+        }
+
+        trace_record_t* rec = &ring[local_head & (TRACE_RING_SIZE - 1)];
+        rec->cycle = trace_cycle++;
+        rec->pc = pc;
+        rec->opcode = CHIP8_CPU->opcode;
+        rec->index = CHIP8_CPU->index;
+        rec->sp = CHIP8_CPU->sp;
+        rec->reserved = 0;
+        rec->reg_mask = 0;
+        rec->reg = TRACE_NO_REG;
+        rec->value = 0;
+        if (memcmp(before, CHIP8_CPU->registers, sizeof(before)) != 0) {
+            for (int r = 15; r >= 0; r--) {
+                if (CHIP8_CPU->registers[r] != before[r]) {
+                    rec->reg_mask |= (uint16_t)(1u << r);
+                    rec->reg = (uint8_t)r;
+                    rec->value = CHIP8_CPU->registers[r];
+                }
+            }
+        }
+        local_head++;
+    }
+
+    // 每批发布一次记录（原子写带完整屏障，避免每条指令付出该开销）
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&ring_head, (int)local_head);
+}
+
+// 写完剩余记录并结束落盘线程
+void trace_close(void)
+{
+    if (!trace_active) return;
+
+    SDL_AtomicSet(&flush_stop, 1);
+    SDL_WaitThread(flush_thread, NULL);
+    flush_thread = NULL;
+    fclose(trace_file);
+    trace_file = NULL;
+    trace_active = 0;
+
+    printf("Trace finished: %u records, producer waited %u times\n", trace_cycle, producer_waits);
+}
+
+// 指令是否匹配模式
+static int op_match(uint16_t opcode, const char* pattern)
+{
+    size_t len = strlen(pattern);
+    if (len == 1) {
+        return isxdigit((unsigned char)pattern[0]) &&
+            (opcode >> 12) == (uint16_t)strtol(pattern, NULL, 16);
+    }
+    if (len != 4) return 0;
+
+    for (int i = 0; i < 4; i++) {
+        char digit[2] = { pattern[i], '\0' };
+        if (!isxdigit((unsigned char)pattern[i])) continue; // 通配
+        if (((opcode >> (12 - i * 4)) & 0xF) != (uint16_t)strtol(digit, NULL, 16)) return 0;
+    }
+    return 1;
+}
+
+// 离线解码追踪文件
+int trace_dump(const char* path, const char* pc_range, const char* op_pattern)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Failed to open trace file: %s\n", path);
+        return -1;
+    }
+
+    char magic[4];
+    uint16_t header[2];
+    if (fread(magic, 1, 4, f) != 4 || memcmp(magic, "C8TR", 4) != 0 ||
+        fread(header, sizeof(uint16_t), 2, f) != 2 ||
+        header[0] != TRACE_VERSION || header[1] != sizeof(trace_record_t)) {
+        fprintf(stderr, "Not a version %d trace file: %s\n", TRACE_VERSION, path);
+        fclose(f);
+        return -1;
+    }
+
+    unsigned long pc_lo = 0, pc_hi = 0xFFFF;
+    if (pc_range && sscanf(pc_range, "%lx-%lx", &pc_lo, &pc_hi) != 2) {
+        fprintf(stderr, "Bad PC range (expected lo-hi in hex): %s\n", pc_range);
+        fclose(f);
+        return -1;
+    }
+
+    trace_record_t recs[1024];
+    size_t got;
+    uint64_t epoch = 0;           // 32位序号回绕次数
+    uint32_t last = 0;
+    uint64_t total = 0, shown = 0;
+
+    while ((got = fread(recs, sizeof(trace_record_t), 1024, f)) > 0) {
+        for (size_t i = 0; i < got; i++) {
+            const trace_record_t* r = &recs[i];
+            if (total > 0 && r->cycle < last) epoch++;
+            last = r->cycle;
+            total++;
+
+            if (r->pc < pc_lo || r->pc > pc_hi) continue;
+            if (op_pattern && !op_match(r->opcode, op_pattern)) continue;
+            shown++;
+
+            printf("%10llu  %03X  %04X  I=%03X SP=%X",
+                (unsigned long long)((epoch << 32) | r->cycle), r->pc, r->opcode, r->index, r->sp);
+            if (r->reg != TRACE_NO_REG) {
+                printf("  V%X=%02X", r->reg, r->value);
+                if (r->reg_mask & ~(1u << r->reg)) printf(" (changed mask %04X)", r->reg_mask);
+            }
+            printf("\n");
+        }
+    }
+    fclose(f);
+
+    fprintf(stderr, "%llu of %llu records shown\n", (unsigned long long)shown, (unsigned long long)total);
+    return 0;
+}
@@ -0,0 +1,38 @@
+#ifndef CHIP8_TRACE_H_
+#define CHIP8_TRACE_H_
+
+#include <stdint.h>
+
+// 追踪参数
+#define TRACE_RING_BITS 16                     // 环形缓冲区容量 2^16 条记录（1MB）
+#define TRACE_RING_SIZE (1u << TRACE_RING_BITS)
+#define TRACE_VERSION 1
+#define TRACE_NO_REG 0xFF
+
+// 追踪记录（16字节定长，按主机字节序写盘）
+// 文件格式：头部 "C8TR" + uint16 版本 + uint16 记录大小，之后为连续记录
+typedef struct {
+    uint32_t cycle;               // 指令序号低32位（解码时按单调递增还原回绕）
+    uint16_t pc;                  // 执行前的程序计数器
+    uint16_t opcode;              // 指令
+    uint16_t index;               // 执行后的索引寄存器I
+    uint16_t reg_mask;            // 本指令改变的寄存器位图（bit n = Vn）
+    uint8_t reg;                  // 第一个改变的寄存器（无则为TRACE_NO_REG）
+    uint8_t value;                // 该寄存器的新值
+    uint8_t sp;                   // 执行后的栈指针
+    uint8_t reserved;
+} trace_record_t;
+
+// 全局变量声明
+extern int trace_active;          // 追踪开启标记（main据此选择运行循环）
+
+// 追踪函数声明
+int trace_open(const char* path); // 开始追踪（启动后台落盘线程，失败返回-1）
+void trace_run(int cycles);       // 追踪运行循环（每条指令写一条记录）
+void trace_close(void);           // 写完剩余记录并结束落盘线程
+
+// 离线解码：打印追踪文件，可按PC范围（如"200-2FF"）与指令模式过滤
+// 指令模式：1位十六进制表示指令类别（如"D"），4位时非十六进制字符为通配（如"8xy4"、"Fx55"）
+int trace_dump(const char* path, const char* pc_range, const char* op_pattern);
+
+#endif
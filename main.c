@@ -6,55 +6,441 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <signal.h>
+#include <time.h>
 #include <SDL2/SDL.h>
 
 #include "chip8_cpu.h"
 #include "chip8_platform.h"
+#include "chip8_debug.h"
+#include "chip8_regress.h"
+#include "chip8_stream.h"
+#include "chip8_capture.h"
+#include "chip8_trace.h"
+#include "chip8_romlib.h"
+#include "chip8_backend.h"
+#include "chip8_state.h"
+#include "chip8_input.h"
+#include "chip8_bench.h"
 
 #define FPS 60
 #define FRAME_DELAY (1000 / FPS)
 
+// Ctrl+C时正常退出主循环（无头模式下用于清理socket文件）
+static void on_signal(int sig)
+{
+    (void)sig;
+    is_running = 0;
+}
+
+// 自检清单路径：依次尝试当前目录、可执行文件所在目录及其上一级目录（从构建目录运行时）
+static const char* selftest_manifest(const char* argv0, char* buf, size_t size)
+{
+    const char* slash = strrchr(argv0, '/');
+    const char* bslash = strrchr(argv0, '\\');
+    if (bslash > slash) slash = bslash;
+    int dir_len = slash ? (int)(slash - argv0 + 1) : 0;
+
+    static const char* const prefixes[] = { NULL, "", "../" };
+    for (size_t i = 0; i < sizeof(prefixes) / sizeof(prefixes[0]); i++) {
+        if (prefixes[i]) snprintf(buf, size, "%.*s%s%s", dir_len, argv0, prefixes[i], REGRESS_SELFTEST_MANIFEST);
+        else snprintf(buf, size, "%s", REGRESS_SELFTEST_MANIFEST);
+        FILE* f = fopen(buf, "r");
+        if (f) {
+            fclose(f);
+            return buf;
+        }
+    }
+    return REGRESS_SELFTEST_MANIFEST; // 均不存在时按原路径报错
+}
+
+// 网格模式：tile_count个实例并排运行在同一窗口（ROM与执行后端均按顺序循环分配）
+// state_path存在时所有实例映射同一基准存档（写时复制共享，无需重新执行启动帧）
+static int run_grid(int tile_count, const char** roms, int rom_count,
+    const chip8_backend_t** backends, int backend_count, const char* state_path)
+{
+    static chip8_cpu_t* tiles[GRID_MAX_TILES];
+    static const chip8_backend_t* tile_backends[GRID_MAX_TILES]; // 每实例的执行后端
+    if (tile_count > GRID_MAX_TILES) tile_count = GRID_MAX_TILES;
+
+    for (int i = 0; i < tile_count; i++) {
+        tile_backends[i] = backends[i % backend_count];
+        if (state_path) {
+            tiles[i] = state_map(state_path);
+            if (!tiles[i]) {
+                for (int j = 0; j < i; j++) cpu_free(tiles[j]);
+                return EXIT_FAILURE;
+            }
+            continue;
+        }
+        tiles[i] = cpu_create();
+        CHIP8_CPU = tiles[i];
+        cpu_seed((uint32_t)time(NULL) + i * 0x9E3779B9u);
+        if (rom_count > 0) {
+            if (romlib_loadrom(roms[i % rom_count], NULL) != 0) {
+                for (int j = 0; j <= i; j++) cpu_free(tiles[j]);
+                CHIP8_CPU = NULL;
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    display_init();
+    grid_init(tiles, tile_count);
+
+    uint32_t frame_start;
+    int frame_time;
+
+    while (is_running)
+    {
+        frame_start = SDL_GetTicks();
+
+        // 1. 检测输入（按键发往焦点实例，grid_init/Tab切换时设置CHIP8_CPU）
+        input_detect();
+        chip8_cpu_t* focus = CHIP8_CPU;
+
+        // 2. 轮流执行每个实例（每帧周期数按各实例的ROM配置）
+        int need_draw = 0;
+        for (int t = 0; t < tile_count; t++) {
+            CHIP8_CPU = tiles[t];
+            tile_backends[t]->run((int)(CHIP8_CPU->cycles_per_frame * speed_coeff));
+            need_draw |= CHIP8_CPU->draw_flag;
+            CHIP8_CPU->draw_flag = 0;
+        }
+        CHIP8_CPU = focus;
+        audio_update(focus); // 只有焦点实例发声
+
+        // 3. 任一实例需要刷新时整体重绘
+        if (need_draw) {
+            grid_update();
+        }
+
+        // 4. 控制帧率（固定60Hz）
+        frame_time = SDL_GetTicks() - frame_start;
+        if (frame_time < FRAME_DELAY) {
+            SDL_Delay(FRAME_DELAY - frame_time);
+        }
+    }
+
+    capture_close();
+    uint32_t divergences = lockstep_close();
+    grid_destroy();
+    display_destroy();
+    audio_destroy();
+    for (int i = 0; i < tile_count; i++) {
+        cpu_free(tiles[i]);
+    }
+    CHIP8_CPU = NULL;
+    return (divergences == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 int main(int argc, char* argv[])
 {
-    // 初始化CPU
-    init();
+    // 解析命令行参数：[--debug] [--regress manifest] [--selftest] [--headless] [--stream socket] [--record file] [--trace file] [--grid N]
+    //               [--romlib dir]... [--profiles file] [--romlib-list] [--backend interp|fast|lockstep] [--tile-backends b1,b2,...]
+    //               [--lockstep-check interp|fast] [--lockstep-interval N]
+    //               [--state file] [--input-probe] [--input-frame] [rom...]
+    //               --bench-instances N [--bench-frames F] [--bench-malloc] rom
+    //               --trace-dump file [--pc lo-hi] [--op pattern]
+    const char* roms[GRID_MAX_TILES];
+    int rom_count = 0;
+    int grid_tiles = 0;
+    const char* rom_path = NULL;
+    const char* regress_manifest = NULL;
+    const char* stream_path = NULL;
+    const char* record_path = NULL;
+    const char* trace_path = NULL;
+    const char* trace_dump_path = NULL;
+    const char* trace_pc = NULL;
+    const char* trace_op = NULL;
+    const char* profiles_path = NULL;
+    const char* state_path = NULL;
+    int bench_count = 0;
+    int bench_frames = BENCH_DEFAULT_FRAMES;
+    int bench_malloc = 0;
+    const chip8_backend_t* backend = &backend_interp;
+    const chip8_backend_t* tile_backends[GRID_MAX_TILES]; // 网格模式各实例的后端（按顺序循环分配，未指定时均为backend）
+    int tile_backend_count = 0;
+    const chip8_backend_t* lockstep_checked = &backend_fast;
+    uint32_t lockstep_interval = LOCKSTEP_DEFAULT_INTERVAL;
+    int list_roms = 0;
+    int use_debugger = 0;
+    int headless = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--debug") == 0) {
+            use_debugger = 1;
+        }
+        else if (strcmp(argv[i], "--headless") == 0) {
+            headless = 1;
+        }
+        else if (strcmp(argv[i], "--stream") == 0 && i + 1 < argc) {
+            stream_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--regress") == 0 && i + 1 < argc) {
+            regress_manifest = argv[++i];
+        }
+        else if (strcmp(argv[i], "--selftest") == 0) {
+            static char selftest_path[1024];
+            regress_manifest = selftest_manifest(argv[0], selftest_path, sizeof(selftest_path));
+        }
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--trace-dump") == 0 && i + 1 < argc) {
+            trace_dump_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--pc") == 0 && i + 1 < argc) {
+            trace_pc = argv[++i];
+        }
+        else if (strcmp(argv[i], "--op") == 0 && i + 1 < argc) {
+            trace_op = argv[++i];
+        }
+        else if (strcmp(argv[i], "--grid") == 0 && i + 1 < argc) {
+            grid_tiles = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--romlib") == 0 && i + 1 < argc) {
+            // 启动时一次性扫描并预加载，之后加载/切换ROM不再读盘
+            int added = romlib_scan(argv[++i]);
+            printf("ROM library: %d ROMs preloaded from %s\n", added, argv[i]);
+        }
+        else if (strcmp(argv[i], "--profiles") == 0 && i + 1 < argc) {
+            profiles_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--romlib-list") == 0) {
+            list_roms = 1;
+        }
+        else if (strcmp(argv[i], "--backend") == 0 && i + 1 < argc) {
+            backend = backend_find(argv[++i]);
+            if (!backend) {
+                fprintf(stderr, "Unknown backend: %s (use interp, fast or lockstep)\n", argv[i]);
+                romlib_destroy();
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[i], "--bench-instances") == 0 && i + 1 < argc) {
+            bench_count = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--bench-frames") == 0 && i + 1 < argc) {
+            bench_frames = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--bench-malloc") == 0) {
+            bench_malloc = 1;
+        }
+        else if (strcmp(argv[i], "--input-probe") == 0) {
+            input_probe = 1;
+        }
+        else if (strcmp(argv[i], "--input-frame") == 0) {
+            input_subframe = 0;
+        }
+        else if (strcmp(argv[i], "--state") == 0 && i + 1 < argc) {
+            state_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--tile-backends") == 0 && i + 1 < argc) {
+            char* list = argv[++i];
+            for (char* name = strtok(list, ","); name && tile_backend_count < GRID_MAX_TILES; name = strtok(NULL, ",")) {
+                tile_backends[tile_backend_count] = backend_find(name);
+                if (!tile_backends[tile_backend_count]) {
+                    fprintf(stderr, "Unknown backend: %s (use interp, fast or lockstep)\n", name);
+                    romlib_destroy();
+                    return EXIT_FAILURE;
+                }
+                tile_backend_count++;
+            }
+        }
+        else if (strcmp(argv[i], "--lockstep-check") == 0 && i + 1 < argc) {
+            lockstep_checked = backend_find(argv[++i]);
+            if (!lockstep_checked || lockstep_checked == &backend_lockstep) {
+                fprintf(stderr, "Cannot lockstep-check backend: %s (use interp or fast)\n", argv[i]);
+                romlib_destroy();
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[i], "--lockstep-interval") == 0 && i + 1 < argc) {
+            lockstep_interval = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else {
+            rom_path = argv[i];
+            if (rom_count < GRID_MAX_TILES) {
+                roms[rom_count++] = argv[i];
+            }
+        }
+    }
+
+    lockstep_configure(lockstep_checked, lockstep_interval);
+    if (tile_backend_count == 0) {
+        tile_backends[tile_backend_count++] = backend;
+    }
+
+    // 追踪运行循环逐条调用cycle()，只能记录解释执行后端（其他后端与锁步校验不参与追踪）
+    if (trace_path && backend != &backend_interp) {
+        fprintf(stderr, "--trace records the interp backend only (got --backend %s)\n", backend->name);
+        romlib_destroy();
+        return EXIT_FAILURE;
+    }
+
+    // 离线解码追踪文件
+    if (trace_dump_path) {
+        return (trace_dump(trace_dump_path, trace_pc, trace_op) == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // 每ROM配置（按内容哈希关联，加载ROM时应用）
+    if (profiles_path && romlib_load_profiles(profiles_path) < 0) {
+        romlib_destroy();
+        return EXIT_FAILURE;
+    }
+
+    // 列出ROM库（用于编写配置文件）
+    if (list_roms) {
+        romlib_list();
+        romlib_destroy();
+        return EXIT_SUCCESS;
+    }
+
+    // 存档路径（F5/F9使用；文件已存在时从存档恢复）
+    FILE* state_file = state_path ? fopen(state_path, "rb") : NULL;
+    int resume = (state_file != NULL);
+    if (state_file) fclose(state_file);
+    if (state_path) state_set_path(state_path);
+
+    // 网格模式（多实例同窗口）
+    if (grid_tiles > 0) {
+        int status = run_grid(grid_tiles, roms, rom_count, tile_backends, tile_backend_count, resume ? state_path : NULL);
+        romlib_destroy();
+        return status;
+    }
 
-    // 若命令行传入ROM路径，直接加载
-    if (argc >= 2) {
-        if (loadrom(argv[1]) != 0) {
-            destroy();
+    // 无头回归测试模式（不初始化SDL，失败时返回非0）
+    if (regress_manifest) {
+        int failures = regress_run(regress_manifest, backend);
+        lockstep_close();
+        destroy();
+        romlib_destroy();
+        return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // 初始化CPU
+    // 从存档恢复时直接映射存档（不解析、不执行启动帧；存档已含内存、全部状态与ROM配置，忽略ROM参数）
+    if (resume) {
+        CHIP8_CPU = state_map(state_path);
+        if (!CHIP8_CPU) {
+            romlib_destroy();
             return EXIT_FAILURE;
         }
+        printf("Resumed from save state: %s\n", state_path);
     }
     else {
-        printf("No ROM path provided - drag .ch8 file to the window to load\n");
+        init();
+
+        // 若命令行传入ROM路径，直接加载（经ROM库，应用该ROM的配置）
+        if (rom_path) {
+            if (romlib_loadrom(rom_path, NULL) != 0) {
+                destroy();
+                romlib_destroy();
+                return EXIT_FAILURE;
+            }
+        }
+        else if (!headless) {
+            printf("No ROM path provided - drag .ch8 file to the window to load\n");
+        }
     }
 
-    // 初始化SDL平台（显示/音频/字体）
-    display_init();
+    // 多实例基准（以已加载ROM的实例为模板，不初始化SDL）
+    if (bench_count > 0) {
+        int status = -1;
+        if (rom_path || resume) {
+            status = bench_instances(bench_count, bench_frames, bench_malloc, backend);
+        }
+        else {
+            fprintf(stderr, "Benchmark needs a ROM or save state\n");
+        }
+        destroy();
+        romlib_destroy();
+        return (status == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // 初始化SDL平台（显示/音频/字体）；无头模式只需要计时器
+    if (headless) {
+        SDL_Init(SDL_INIT_TIMER);
+        signal(SIGINT, on_signal);
+    }
+    else {
+        display_init();
+        input_set_keymap(CHIP8_CPU->keymap); // ROM配置或存档中的键位
+    }
+
+    // 启动帧推流（Unix域socket）
+    if (stream_path && stream_open(stream_path) != 0) {
+        if (!headless) {
+            display_destroy();
+            audio_destroy();
+        }
+        destroy();
+        romlib_destroy();
+        return EXIT_FAILURE;
+    }
+
+    // 开始录制（后台线程编码，不阻塞帧循环）
+    if (record_path && capture_open(record_path) != 0) {
+        fprintf(stderr, "Recording disabled\n");
+    }
+
+    // 开始指令追踪（后台线程落盘）
+    if (trace_path && trace_open(trace_path) != 0) {
+        fprintf(stderr, "Tracing disabled\n");
+    }
+
+    // 挂载调试器（通过stdin控制台交互）
+    if (use_debugger) {
+        debug_attach();
+    }
 
     // 主循环
-    uint32_t frame_start;
+    uint32_t frame_start = SDL_GetTicks();
+    uint32_t last_frame_start;
     int frame_time;
 
     while (is_running)
     {
+        last_frame_start = frame_start;
         frame_start = SDL_GetTicks();
 
-        // 1. 检测输入（键盘/拖放/窗口关闭）
-        input_detect();
+        // 1. 检测输入（键盘/拖放/窗口关闭，以及推流观看端的按键）
+        if (!headless) {
+            input_detect();
+        }
+        stream_poll_input();
 
         // 2. 执行CPU周期（按速度系数调整每帧执行次数）
-        int cycles_per_frame = (int)(BASE_CYCLES_PER_FRAME * speed_coeff);
-        for (int i = 0; i < cycles_per_frame; i++) {
-            cycle();
+        //    调试器挂载/追踪开启时使用独立的运行循环，否则交给所选执行后端
+        //    批次对应上一帧间隔，排队的按键按时间戳在批次内对应周期生效
+        int cycles_per_frame = (int)(CHIP8_CPU->cycles_per_frame * speed_coeff);
+        void (*run)(int) = backend->run;
+        if (debug_attached) {
+            run = debug_run;
+        }
+        else if (trace_active) {
+            run = trace_run;
+        }
+        if (run != backend->run) {
+            lockstep_sync(CHIP8_CPU); // 其他运行循环接管期间不做锁步校验，回到后端时从当前状态重新开始
+        }
+        input_run_frame(run, cycles_per_frame, last_frame_start, frame_start);
+        if (!headless) {
+            audio_update(CHIP8_CPU);
         }
 
-        // 3. 刷新屏幕（如果需要）
+        // 3. 刷新屏幕/推送帧（如果需要）
         if (CHIP8_CPU->draw_flag) {
-            display_update();
+            if (!headless) {
+                display_update();
+            }
+            stream_frame();
             CHIP8_CPU->draw_flag = 0;
         }
+        capture_frame(); // 每帧复制一份交给录制线程（按60fps输出）
 
         // 4. 控制帧率（固定60Hz）
         frame_time = SDL_GetTicks() - frame_start;
@@ -63,10 +449,26 @@ int main(int argc, char* argv[])
         }
     }
 
+    // 无头模式退出时保存会话（下次以--state直接映射恢复）
+    if (headless && state_path && state_save(state_path, CHIP8_CPU, 1) == 0) {
+        printf("Session saved: %s\n", state_path);
+    }
+
     // 清理资源
-    display_destroy();
-    audio_destroy();
+    input_probe_report();
+    uint32_t divergences = lockstep_close();
+    trace_close();
+    capture_close();
+    stream_close();
+    if (headless) {
+        SDL_Quit();
+    }
+    else {
+        display_destroy();
+        audio_destroy();
+    }
     destroy();
+    romlib_destroy();
 
-    return EXIT_SUCCESS;
+    return (divergences == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
 }